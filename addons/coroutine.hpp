@@ -0,0 +1,398 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <ncs/world.hpp>
+
+namespace ncs
+{
+	class Executor;
+
+	namespace detail
+	{
+		struct TaskPromiseBase
+		{
+			std::coroutine_handle<> continuation; /* the task awaiting this one, if any */
+			Executor *executor = nullptr;         /* set for tasks spawned on an executor */
+			std::exception_ptr error;
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				template<typename Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+
+				void await_resume() const noexcept {}
+			};
+
+			FinalAwaiter final_suspend() noexcept
+			{
+				return {};
+			}
+
+			void unhandled_exception()
+			{
+				error = std::current_exception();
+			}
+		};
+
+		template<typename T>
+		struct TaskPromise : TaskPromiseBase
+		{
+			T value {};
+
+			void return_value(T v)
+			{
+				value = std::move(v);
+			}
+
+			T result()
+			{
+				if (error)
+					std::rethrow_exception(error);
+				return std::move(value);
+			}
+		};
+
+		template<>
+		struct TaskPromise<void> : TaskPromiseBase
+		{
+			void return_void() const noexcept {}
+
+			void result() const
+			{
+				if (error)
+					std::rethrow_exception(error);
+			}
+		};
+	}
+
+	/*
+	 * a lazily started coroutine. a task runs once it is either awaited by another task, which resumes
+	 * when it completes, or handed to `Executor::spawn()`. awaiting yields the task's result and rethrows
+	 * whatever escaped it
+	 */
+	template<typename T = void>
+	class Task
+	{
+	public:
+		struct promise_type : detail::TaskPromise<T>
+		{
+			Task get_return_object()
+			{
+				return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+		};
+
+		Task() = default;
+
+		explicit Task(const std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+		Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+		Task &operator=(Task &&other) noexcept
+		{
+			if (this != &other)
+			{
+				if (handle)
+					handle.destroy();
+				handle = std::exchange(other.handle, nullptr);
+			}
+			return *this;
+		}
+
+		Task(const Task &) = delete;
+
+		Task &operator=(const Task &) = delete;
+
+		~Task()
+		{
+			if (handle)
+				handle.destroy();
+		}
+
+		[[nodiscard]] bool done() const
+		{
+			return !handle || handle.done();
+		}
+
+		bool await_ready() const noexcept
+		{
+			return done();
+		}
+
+		std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept
+		{
+			handle.promise().continuation = awaiting;
+			return handle; /* symmetric transfer: the awaited task runs right away */
+		}
+
+		T await_resume()
+		{
+			return handle.promise().result();
+		}
+
+		/* gives up ownership of the coroutine frame */
+		std::coroutine_handle<promise_type> release()
+		{
+			return std::exchange(handle, nullptr);
+		}
+
+	private:
+		std::coroutine_handle<promise_type> handle;
+	};
+
+	/*
+	 * resumes suspended tasks once per frame, from `tick()`. a world keeps one as a resource, see
+	 * `executor()`, and `Scheduler::run()` ticks it before the first system of the frame runs. nothing is
+	 * polled: frame waits sit in a timer heap ordered by due frame, and `wait_for()` waiters are woken by
+	 * an `on_add` observer, so a frame costs only as much as the tasks that actually resume
+	 *
+	 * not thread-safe; tasks run on the thread calling `tick()`
+	 */
+	class Executor
+	{
+	public:
+		explicit Executor(World &world) : world(world), state(std::make_shared<State>()) {}
+
+		~Executor()
+		{
+			/* suspended handles point into the frames about to go away */
+			state->ready.clear();
+			timers = {};
+			state->waiters.clear();
+			for (void *root: roots)
+				std::coroutine_handle<>::from_address(root).destroy();
+		}
+
+		Executor(const Executor &) = delete;
+
+		Executor &operator=(const Executor &) = delete;
+
+		/* takes ownership of `task`; it starts on the next `tick()` */
+		void spawn(Task<> task)
+		{
+			const auto handle = task.release();
+			handle.promise().executor = this;
+			roots.insert(handle.address());
+			state->ready.emplace_back(handle);
+		}
+
+		/* runs one frame: resumes every task whose wait is over, then rethrows the first error that ended a task */
+		void tick()
+		{
+			++current_frame;
+
+			std::vector<std::coroutine_handle<> > resuming = std::move(state->ready);
+			state->ready.clear();
+			while (!timers.empty() && timers.top().first <= current_frame)
+			{
+				resuming.emplace_back(timers.top().second);
+				timers.pop();
+			}
+
+			for (const std::coroutine_handle<> handle: resuming)
+				handle.resume();
+
+			std::exception_ptr error;
+			for (const auto &[handle, failure]: finished)
+			{
+				if (!error)
+					error = failure;
+				roots.erase(handle.address());
+				handle.destroy();
+			}
+			finished.clear();
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		/* frames ticked so far */
+		[[nodiscard]] std::uint64_t frame() const
+		{
+			return current_frame;
+		}
+
+		/* spawned tasks that have not completed yet */
+		[[nodiscard]] std::size_t pending() const
+		{
+			return roots.size();
+		}
+
+		/* resumes `handle` on the `frames`-th tick from now */
+		void resume_after(const std::coroutine_handle<> handle, const std::uint64_t frames)
+		{
+			timers.emplace(current_frame + frames, handle);
+		}
+
+		/* resumes `handle` on the tick after `T` is next added to `e` */
+		template<typename T>
+		void resume_on_add(const std::coroutine_handle<> handle, const Entity e)
+		{
+			auto &waiting = state->waiters[key<T>()];
+			if (state->observed.insert(key<T>()).second)
+			{
+				world.on_add<T>([state = state](const std::span<const Entity> entities, const std::span<T>)
+				{
+					state->wake(key<T>(), entities);
+				});
+			}
+			waiting[e].emplace_back(handle);
+		}
+
+		/* called by a spawned task as it completes */
+		void finish(const std::coroutine_handle<> handle, std::exception_ptr error)
+		{
+			finished.emplace_back(handle, std::move(error));
+		}
+
+		World &world;
+
+	private:
+		/* shared with the observers, which may outlive the executor */
+		struct State
+		{
+			std::vector<std::coroutine_handle<> > ready; /* resumed on the next tick */
+			std::unordered_set<const void *> observed;  /* component types with an `on_add` observer */
+			std::unordered_map<const void *, std::unordered_map<Entity, std::vector<std::coroutine_handle<> > > > waiters;
+
+			void wake(const void *type, const std::span<const Entity> entities)
+			{
+				const auto it = waiters.find(type);
+				if (it == waiters.end() || it->second.empty())
+					return;
+
+				for (const Entity e: entities)
+				{
+					if (const auto waiting = it->second.find(e);
+						waiting != it->second.end())
+					{
+						ready.insert(ready.end(), waiting->second.begin(), waiting->second.end());
+						it->second.erase(waiting);
+					}
+				}
+			}
+		};
+
+		/* one address per component type, without asking the world for a component id */
+		template<typename T>
+		static const void *key()
+		{
+			static const char id = 0;
+			return &id;
+		}
+
+		using Timer = std::pair<std::uint64_t, std::coroutine_handle<> >;
+
+		struct Later
+		{
+			bool operator()(const Timer &a, const Timer &b) const
+			{
+				return a.first > b.first;
+			}
+		};
+
+		std::shared_ptr<State> state;
+		std::priority_queue<Timer, std::vector<Timer>, Later> timers; /* earliest due frame on top */
+		std::unordered_set<void *> roots;                              /* frames of spawned tasks, owned here */
+		std::vector<std::pair<std::coroutine_handle<>, std::exception_ptr> > finished; /* destroyed at the end of the tick */
+		std::uint64_t current_frame = 0;
+	};
+
+	template<typename Promise>
+	std::coroutine_handle<> detail::TaskPromiseBase::FinalAwaiter::await_suspend(
+		const std::coroutine_handle<Promise> handle) noexcept
+	{
+		TaskPromiseBase &promise = handle.promise();
+		if (promise.continuation)
+			return promise.continuation;
+
+		/* a spawned task stays suspended here until the executor destroys it at the end of the tick */
+		if (promise.executor)
+			promise.executor->finish(handle, promise.error);
+		return std::noop_coroutine();
+	}
+
+	/* the executor of `world`; created on first use and kept as an `Executor` resource */
+	inline Executor &executor(World &world)
+	{
+		if (Executor *existing = world.resource<Executor>())
+			return *existing;
+		return world.set_resource<Executor>(world);
+	}
+
+	struct FrameAwaiter
+	{
+		Executor &executor;
+		std::uint64_t frames;
+
+		bool await_ready() const noexcept
+		{
+			return frames == 0;
+		}
+
+		void await_suspend(const std::coroutine_handle<> handle) const
+		{
+			executor.resume_after(handle, frames);
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+	template<typename T>
+	struct AddAwaiter
+	{
+		Executor &executor;
+		Entity entity;
+
+		bool await_ready() const
+		{
+			return !executor.world.is_alive(entity) || executor.world.has<T>(entity);
+		}
+
+		void await_suspend(const std::coroutine_handle<> handle) const
+		{
+			executor.resume_on_add<T>(handle, entity);
+		}
+
+		T *await_resume() const
+		{
+			return executor.world.is_alive(entity) ? executor.world.get<T>(entity) : nullptr;
+		}
+	};
+
+	/* `co_await next_frame(world)` suspends until the next tick, or the `frames`-th one from now */
+	inline FrameAwaiter next_frame(World &world, const std::uint64_t frames = 1)
+	{
+		return { executor(world), frames };
+	}
+
+	/*
+	 * `co_await wait_for<T>(world, e)` suspends until `T` is added to `e` and yields it, or nullptr when
+	 * `e` is dead or has lost `T` again by the time the task resumes. a wait on an entity that is
+	 * despawned first never ends; the task is destroyed together with the executor
+	 */
+	template<typename T>
+	AddAwaiter<T> wait_for(World &world, const Entity e)
+	{
+		return { executor(world), e };
+	}
+}
@@ -1,3 +1,441 @@
 #pragma once
 
-/* WIP */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <ncs/world.hpp>
+#include <addons/coroutine.hpp>
+
+namespace ncs
+{
+	/* the phases of a frame, run in this order; each ends with a sync point that applies deferred commands */
+	enum class Stage : std::uint8_t
+	{
+		PRE_UPDATE,
+		UPDATE,
+		POST_UPDATE,
+		EXTRACT /* copies what the renderer needs out of the world */
+	};
+
+	constexpr std::size_t STAGE_COUNT = 4;
+
+	/* one run of a system, as recorded by the profiler */
+	struct TraceEvent
+	{
+		std::size_t system = 0;
+		std::uint32_t thread = 0;      /* scheduler thread; 0 is the one calling `run()` */
+		std::uint64_t start_ns = 0;    /* since the scheduler was created */
+		std::uint64_t duration_ns = 0;
+		std::size_t entities = 0;      /* as returned by the system; zero for systems returning nothing */
+	};
+
+	/* totals of one system since profiling was last switched on or cleared */
+	struct SystemTiming
+	{
+		std::uint64_t runs = 0;
+		std::uint64_t total_ns = 0;
+		std::uint64_t last_ns = 0;
+		std::size_t entities = 0;      /* processed by the last run */
+		std::uint32_t thread = 0;      /* the last run ran on */
+	};
+
+	/*
+	 * trace events of a single thread. only the owning thread pushes, so a push is two plain stores and
+	 * a release of the head; readers look at the ring between runs. once full, the oldest events are
+	 * overwritten
+	 */
+	class alignas(64) TraceRing
+	{
+	public:
+		explicit TraceRing(const std::size_t capacity) : events(std::max<std::size_t>(capacity, 1)) {}
+
+		void push(const TraceEvent &event)
+		{
+			const std::uint64_t at = head.load(std::memory_order_relaxed);
+			events[at % events.size()] = event;
+			head.store(at + 1, std::memory_order_release);
+		}
+
+		/* visits the retained events, oldest first */
+		template<typename Fn>
+		void visit(Fn &&fn) const
+		{
+			const std::uint64_t end = head.load(std::memory_order_acquire);
+			const std::uint64_t begin = end > events.size() ? end - events.size() : 0;
+			for (std::uint64_t i = begin; i < end; ++i)
+				fn(events[i % events.size()]);
+		}
+
+		void clear()
+		{
+			head.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		std::vector<TraceEvent> events;
+		std::atomic<std::uint64_t> head = 0;
+	};
+
+	/*
+	 * runs systems over a world on a fixed pool of threads. a frame walks the stages in order; within a
+	 * stage, systems are grouped into waves in the order they were added: a system joins the wave after
+	 * the last earlier system of its stage its `Access` conflicts with, and the systems of one wave run in
+	 * parallel. systems of the same wave must therefore stay within what they declared. `World::query()`
+	 * is safe to call from every system of a wave; component ids are registered when an `Access` is built
+	 * with `World::access()`, so the readers of a wave never register types concurrently
+	 *
+	 * a system may take a `Commands &` after the world to defer spawns, sets, removes and despawns. every
+	 * thread records into its own buffer, and all of them are applied together, in a single
+	 * `World::apply()`, at the end of the stage
+	 *
+	 * the built-in profiler is off by default and costs a relaxed load per system run while off. once
+	 * switched on it times every run into a per-thread ring, which `write_trace()` exports as Chrome
+	 * `trace_event` JSON for chrome://tracing or Perfetto
+	 */
+	class Scheduler
+	{
+	public:
+		/* a system returns nothing, or the number of entities it processed for the profiler to record */
+		using SystemFn = std::function<std::size_t(World &, Commands &)>;
+
+		static constexpr std::size_t TRACE_CAPACITY = 4096; /* events kept per thread */
+
+		explicit Scheduler(World &world, const std::size_t threads = std::thread::hardware_concurrency(),
+		                   const std::size_t trace_capacity = TRACE_CAPACITY) :
+			world(world), epoch(std::chrono::steady_clock::now())
+		{
+			const std::size_t count = std::max<std::size_t>(threads, 1);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				rings.emplace_back(std::make_unique<TraceRing>(trace_capacity));
+				buffers.emplace_back(world);
+			}
+			for (std::size_t i = 1; i < count; ++i)
+				workers.emplace_back([this, i] { work(static_cast<std::uint32_t>(i)); });
+		}
+
+		~Scheduler()
+		{
+			{
+				std::lock_guard lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (std::thread &worker: workers)
+				worker.join();
+		}
+
+		Scheduler(const Scheduler &) = delete;
+
+		Scheduler &operator=(const Scheduler &) = delete;
+
+		/*
+		 * `fn` takes `World &`, optionally followed by `Commands &`, and returns nothing or the number of
+		 * entities it processed. returns the system's index
+		 */
+		template<typename Fn>
+		std::size_t add(const Stage stage, std::string name, Access access, Fn &&fn)
+		{
+			SystemFn wrapped;
+			if constexpr (std::is_invocable_v<Fn &, World &, Commands &>)
+			{
+				wrapped = [fn = std::forward<Fn>(fn)](World &w, Commands &commands) mutable -> std::size_t
+				{
+					if constexpr (std::is_void_v<std::invoke_result_t<Fn &, World &, Commands &> >)
+					{
+						fn(w, commands);
+						return 0;
+					}
+					else
+					{
+						return static_cast<std::size_t>(fn(w, commands));
+					}
+				};
+			}
+			else
+			{
+				wrapped = [fn = std::forward<Fn>(fn)](World &w, Commands &) mutable -> std::size_t
+				{
+					if constexpr (std::is_void_v<std::invoke_result_t<Fn &, World &> >)
+					{
+						fn(w);
+						return 0;
+					}
+					else
+					{
+						return static_cast<std::size_t>(fn(w));
+					}
+				};
+			}
+
+			systems.push_back({ std::move(name), std::move(access), std::move(wrapped), stage, {} });
+			built = false;
+			return systems.size() - 1;
+		}
+
+		/* adds to `Stage::UPDATE` */
+		template<typename Fn>
+		std::size_t add(std::string name, Access access, Fn &&fn)
+		{
+			return add(Stage::UPDATE, std::move(name), std::move(access), std::forward<Fn>(fn));
+		}
+
+		/* runs one frame: resumes the world's coroutine tasks, then every stage followed by its sync point */
+		void run()
+		{
+			if (Executor *tasks = world.resource<Executor>())
+				tasks->tick();
+
+			if (!built)
+				build_waves();
+			for (const auto &stage: waves)
+			{
+				for (const std::vector<std::size_t> &wave: stage)
+					execute(wave);
+				flush();
+			}
+		}
+
+		void set_profiling(const bool enabled)
+		{
+			profiling_enabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] bool profiling() const
+		{
+			return profiling_enabled.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] const SystemTiming &timing(const std::size_t system) const
+		{
+			return systems.at(system).timing;
+		}
+
+		[[nodiscard]] std::size_t thread_count() const
+		{
+			return rings.size();
+		}
+
+		/* drops the recorded events and timings; call between runs */
+		void clear_trace()
+		{
+			for (const auto &ring: rings)
+				ring->clear();
+			for (System &system: systems)
+				system.timing = {};
+		}
+
+		/* writes the recorded events as Chrome `trace_event` JSON; call between runs */
+		void write_trace(std::ostream &out) const
+		{
+			const auto flags = out.flags();
+			const auto precision = out.precision();
+			out.setf(std::ios::fixed, std::ios::floatfield);
+			out.precision(3);
+
+			out << "{\"traceEvents\":[";
+			bool first = true;
+			for (std::size_t thread = 0; thread < rings.size(); ++thread)
+			{
+				out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+					<< ",\"args\":{\"name\":\"" << (thread == 0 ? "main" : "worker " + std::to_string(thread)) << "\"}}";
+				first = false;
+			}
+
+			for (const auto &ring: rings)
+			{
+				ring->visit([this, &out](const TraceEvent &event)
+				{
+					out << ",\n{\"name\":\"";
+					write_escaped(out, systems[event.system].name);
+					out << "\",\"cat\":\"" << STAGE_NAMES[static_cast<std::size_t>(systems[event.system].stage)]
+						<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+						<< ",\"ts\":" << static_cast<double>(event.start_ns) / 1000.0
+						<< ",\"dur\":" << static_cast<double>(event.duration_ns) / 1000.0
+						<< ",\"args\":{\"entities\":" << event.entities << "}}";
+				});
+			}
+			out << "\n]}\n";
+
+			out.flags(flags);
+			out.precision(precision);
+		}
+
+	private:
+		static constexpr std::array<const char *, STAGE_COUNT> STAGE_NAMES = {
+			"pre_update", "update", "post_update", "extract"
+		};
+
+		struct System
+		{
+			std::string name;
+			Access access;
+			SystemFn fn;
+			Stage stage;
+			SystemTiming timing;
+		};
+
+		void build_waves()
+		{
+			for (auto &stage: waves)
+				stage.clear();
+
+			std::vector<std::size_t> wave_of(systems.size(), 0);
+			for (std::size_t i = 0; i < systems.size(); ++i)
+			{
+				for (std::size_t j = 0; j < i; ++j)
+				{
+					if (systems[i].stage == systems[j].stage && systems[i].access.conflicts(systems[j].access))
+						wave_of[i] = std::max(wave_of[i], wave_of[j] + 1);
+				}
+
+				auto &stage = waves[static_cast<std::size_t>(systems[i].stage)];
+				if (wave_of[i] >= stage.size())
+					stage.resize(wave_of[i] + 1);
+				stage[wave_of[i]].emplace_back(i);
+			}
+			built = true;
+		}
+
+		/* the sync point: every thread's commands in one batch */
+		void flush()
+		{
+			if (std::ranges::any_of(buffers, [](const Commands &commands) { return !commands.empty(); }))
+				world.apply(buffers);
+		}
+
+		void execute(const std::vector<std::size_t> &wave)
+		{
+			if (workers.empty() || wave.size() == 1)
+			{
+				for (const std::size_t system: wave)
+					run_system(system, 0);
+				return;
+			}
+
+			{
+				std::lock_guard lock(mutex);
+				current = &wave;
+				next = 0;
+				remaining = wave.size();
+				++round;
+			}
+			wake.notify_all();
+
+			drain(0);
+			std::unique_lock lock(mutex);
+			done.wait(lock, [this] { return remaining == 0; });
+			current = nullptr;
+		}
+
+		/* claims systems of the current wave until none are left */
+		void drain(const std::uint32_t thread)
+		{
+			for (;;)
+			{
+				std::size_t system;
+				{
+					std::lock_guard lock(mutex);
+					if (!current || next >= current->size())
+						return;
+					system = (*current)[next++];
+				}
+
+				run_system(system, thread);
+
+				std::lock_guard lock(mutex);
+				if (--remaining == 0)
+					done.notify_one();
+			}
+		}
+
+		void work(const std::uint32_t thread)
+		{
+			std::uint64_t seen = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock lock(mutex);
+					wake.wait(lock, [this, seen] { return stopping || round != seen; });
+					if (stopping)
+						return;
+					seen = round;
+				}
+				drain(thread);
+			}
+		}
+
+		void run_system(const std::size_t index, const std::uint32_t thread)
+		{
+			System &system = systems[index];
+			if (!profiling_enabled.load(std::memory_order_relaxed))
+			{
+				system.fn(world, buffers[thread]);
+				return;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			const std::size_t entities = system.fn(world, buffers[thread]);
+			const auto end = std::chrono::steady_clock::now();
+
+			const auto ns = [](const auto duration)
+			{
+				return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+			};
+			const TraceEvent event = { index, thread, ns(start - epoch), ns(end - start), entities };
+			rings[thread]->push(event);
+
+			/* a system runs on one thread at a time, and waves are joined before the next one starts */
+			system.timing.runs += 1;
+			system.timing.total_ns += event.duration_ns;
+			system.timing.last_ns = event.duration_ns;
+			system.timing.entities = entities;
+			system.timing.thread = thread;
+		}
+
+		static void write_escaped(std::ostream &out, const std::string &text)
+		{
+			for (const char c: text)
+			{
+				if (c == '"' || c == '\\')
+					out << '\\' << c;
+				else if (static_cast<unsigned char>(c) < 0x20)
+					out << ' ';
+				else
+					out << c;
+			}
+		}
+
+		World &world;
+		std::vector<System> systems;
+		std::array<std::vector<std::vector<std::size_t> >, STAGE_COUNT> waves; /* per stage */
+		bool built = false; /* waves are rebuilt on the next `run()` after a system is added */
+		std::vector<Commands> buffers; /* indexed by scheduler thread */
+
+		const std::chrono::steady_clock::time_point epoch;
+		std::atomic<bool> profiling_enabled = false;
+		std::vector<std::unique_ptr<TraceRing> > rings; /* indexed by scheduler thread */
+
+		/* the wave being run; guarded by `mutex` */
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		const std::vector<std::size_t> *current = nullptr;
+		std::size_t next = 0;
+		std::size_t remaining = 0;
+		std::uint64_t round = 0;
+		bool stopping = false;
+		std::vector<std::thread> workers;
+	};
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <ncs/world.hpp>
+
+namespace ncs
+{
+	/* default projection of a position component onto the grid plane */
+	struct ProjectXY
+	{
+		template<typename T>
+		std::array<float, 2> operator()(const T &position) const
+		{
+			return { position.x, position.y };
+		}
+	};
+
+	/*
+	 * uniform grid over the entities holding `T`, kept up to date through the world's observers rather
+	 * than rebuilt: `set<T>()` moves an entity between cells, `remove<T>()` and `despawn()` drop it.
+	 * writes that bypass `set()` (pointers from `get()`, `query()` or `chunks()`) are picked up by
+	 * calling `touch()` for the entities involved. queries return entities whose projected position
+	 * lies inside the shape, using the position cached at the last update
+	 */
+	template<typename T, typename Project = ProjectXY>
+	class SpatialGrid
+	{
+	public:
+		SpatialGrid(World &world, const float cell_size, Project project = {}) :
+			world(world), state(std::make_shared<State>(cell_size, std::move(project)))
+		{
+			set_observer = world.on_set<T>([state = state](const std::span<const Entity> entities, const std::span<T> values)
+			{
+				for (size_t i = 0; i < entities.size(); ++i)
+					state->place(entities[i], values[i]);
+			});
+			remove_observer = world.on_remove<T>([state = state](const std::span<const Entity> entities, const std::span<T>)
+			{
+				for (const Entity e: entities)
+					state->erase(e);
+			});
+
+			for (const auto &[e, value]: world.template query<T>(true))
+				state->place(e, *value);
+		}
+
+		/* the world must outlive the grid; its observers go with it */
+		~SpatialGrid()
+		{
+			world.unobserve(set_observer);
+			world.unobserve(remove_observer);
+		}
+
+		SpatialGrid(const SpatialGrid &) = delete;
+
+		SpatialGrid &operator=(const SpatialGrid &) = delete;
+
+		/* re-reads `T` of `e` after it was written in place */
+		void touch(const Entity e)
+		{
+			if (const T *value = world.template get<T>(e))
+				state->place(e, *value);
+			else
+				state->erase(e);
+		}
+
+		/* appends the entities within `radius` of (`x`, `y`) to `out` */
+		void radius(const float x, const float y, const float radius, std::vector<Entity> &out) const
+		{
+			const float r2 = radius * radius;
+			state->visit(x - radius, y - radius, x + radius, y + radius, [&](const Slot &slot)
+			{
+				const float dx = slot.x - x;
+				const float dy = slot.y - y;
+				if (dx * dx + dy * dy <= r2)
+					out.emplace_back(slot.entity);
+			});
+		}
+
+		/* appends the entities inside the box [`min_x`, `max_x`] x [`min_y`, `max_y`] to `out` */
+		void aabb(const float min_x, const float min_y, const float max_x, const float max_y,
+		          std::vector<Entity> &out) const
+		{
+			state->visit(min_x, min_y, max_x, max_y, [&](const Slot &slot)
+			{
+				if (slot.x >= min_x && slot.x <= max_x && slot.y >= min_y && slot.y <= max_y)
+					out.emplace_back(slot.entity);
+			});
+		}
+
+		[[nodiscard]] size_t size() const
+		{
+			return state->slots.size();
+		}
+
+	private:
+		struct Slot
+		{
+			Entity entity;
+			float x, y;
+		};
+
+		struct Where
+		{
+			std::uint64_t cell;
+			size_t index; /* position inside the cell */
+		};
+
+		struct State
+		{
+			float inverse_cell;
+			Project project;
+			std::unordered_map<std::uint64_t, std::vector<Slot> > cells;
+			std::unordered_map<std::uint64_t, Where> slots; /* keyed by entity id */
+
+			/* cell coordinates every occupied cell lies within; only shrunk once the grid is empty */
+			std::int32_t min_cx = std::numeric_limits<std::int32_t>::max();
+			std::int32_t min_cy = std::numeric_limits<std::int32_t>::max();
+			std::int32_t max_cx = std::numeric_limits<std::int32_t>::min();
+			std::int32_t max_cy = std::numeric_limits<std::int32_t>::min();
+
+			State(const float cell_size, Project project) : inverse_cell(1.0f / cell_size), project(std::move(project)) {}
+
+			/* saturates instead of overflowing for positions and query bounds far outside the grid */
+			[[nodiscard]] std::int32_t coord(const float v) const
+			{
+				const double cell = std::floor(static_cast<double>(v) * inverse_cell);
+				if (!(cell >= std::numeric_limits<std::int32_t>::min()))
+					return std::numeric_limits<std::int32_t>::min();
+				if (!(cell <= std::numeric_limits<std::int32_t>::max()))
+					return std::numeric_limits<std::int32_t>::max();
+				return static_cast<std::int32_t>(cell);
+			}
+
+			static std::uint64_t key(const std::int32_t cx, const std::int32_t cy)
+			{
+				return static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32 | static_cast<std::uint32_t>(cy);
+			}
+
+			void place(const Entity e, const T &value)
+			{
+				const auto [x, y] = project(value);
+				const std::int32_t cx = coord(x);
+				const std::int32_t cy = coord(y);
+				const std::uint64_t cell = key(cx, cy);
+				const std::uint64_t id = World::get_eid(e);
+
+				if (const auto it = slots.find(id); it != slots.end())
+				{
+					/* staying inside the cell is the common case: only the cached position changes */
+					if (it->second.cell == cell)
+					{
+						cells[cell][it->second.index] = { e, x, y };
+						return;
+					}
+					erase(e);
+				}
+
+				auto &bucket = cells[cell];
+				slots[id] = { cell, bucket.size() };
+				bucket.push_back({ e, x, y });
+
+				min_cx = std::min(min_cx, cx);
+				min_cy = std::min(min_cy, cy);
+				max_cx = std::max(max_cx, cx);
+				max_cy = std::max(max_cy, cy);
+			}
+
+			void erase(const Entity e)
+			{
+				const auto it = slots.find(World::get_eid(e));
+				if (it == slots.end())
+					return;
+
+				/* swap-remove inside the cell and patch the slot that moved */
+				auto &bucket = cells[it->second.cell];
+				const size_t index = it->second.index;
+				if (index + 1 != bucket.size())
+				{
+					bucket[index] = bucket.back();
+					slots[World::get_eid(bucket[index].entity)].index = index;
+				}
+				bucket.pop_back();
+				if (bucket.empty())
+					cells.erase(it->second.cell);
+				slots.erase(it);
+
+				if (cells.empty())
+				{
+					min_cx = min_cy = std::numeric_limits<std::int32_t>::max();
+					max_cx = max_cy = std::numeric_limits<std::int32_t>::min();
+				}
+			}
+
+			/*
+			 * visits the cells overlapping the box. the range is clamped to the occupied bounds, and a range
+			 * spanning more cells than are occupied walks the occupied cells instead
+			 */
+			template<typename Fn>
+			void visit(const float min_x, const float min_y, const float max_x, const float max_y, Fn &&fn) const
+			{
+				const std::int64_t lo_x = std::max(coord(min_x), min_cx);
+				const std::int64_t lo_y = std::max(coord(min_y), min_cy);
+				const std::int64_t hi_x = std::min(coord(max_x), max_cx);
+				const std::int64_t hi_y = std::min(coord(max_y), max_cy);
+				if (lo_x > hi_x || lo_y > hi_y)
+					return;
+
+				if (static_cast<double>(hi_x - lo_x + 1) * static_cast<double>(hi_y - lo_y + 1) > static_cast<double>(cells.size()))
+				{
+					for (const auto &[cell, bucket]: cells)
+					{
+						const auto cx = static_cast<std::int32_t>(static_cast<std::uint32_t>(cell >> 32));
+						const auto cy = static_cast<std::int32_t>(static_cast<std::uint32_t>(cell));
+						if (cx >= lo_x && cx <= hi_x && cy >= lo_y && cy <= hi_y)
+						{
+							for (const Slot &slot: bucket)
+								fn(slot);
+						}
+					}
+					return;
+				}
+
+				for (std::int64_t cx = lo_x; cx <= hi_x; ++cx)
+				{
+					for (std::int64_t cy = lo_y; cy <= hi_y; ++cy)
+					{
+						const auto it = cells.find(key(static_cast<std::int32_t>(cx), static_cast<std::int32_t>(cy)));
+						if (it == cells.end())
+							continue;
+						for (const Slot &slot: it->second)
+							fn(slot);
+					}
+				}
+			}
+		};
+
+		World &world;
+		std::shared_ptr<State> state;
+		ObserverHandle set_observer;
+		ObserverHandle remove_observer;
+	};
+}
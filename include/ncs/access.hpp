@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+	/* access terms; `World::access<Read<Position>, Write<Velocity>, ReadResource<Time> >()` */
+	template<typename T>
+	struct Read {};
+
+	template<typename T>
+	struct Write {};
+
+	template<typename T>
+	struct ReadResource {};
+
+	template<typename T>
+	struct WriteResource {};
+
+	/* what a system touches; two systems may run in parallel when their accesses do not conflict */
+	struct Access
+	{
+		std::vector<Component> reads;
+		std::vector<Component> writes;
+		std::vector<std::size_t> resource_reads;
+		std::vector<std::size_t> resource_writes;
+
+		/* true when either side writes something the other one reads or writes */
+		[[nodiscard]] bool conflicts(const Access& other) const;
+	};
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ncs
+{
+	/*
+	 * hot-path counters for structural work. they are only maintained when the library is built with
+	 * `NCS_COUNTERS_ENABLE`, otherwise every `NCS_COUNT` expands to nothing and the values stay zero
+	 */
+	struct Counters
+	{
+		std::uint64_t archetypes_created = 0;
+		std::uint64_t entity_moves = 0;          /* `move_entity` calls */
+		std::uint64_t bytes_moved = 0;           /* component bytes copied by `move_entity` */
+		std::uint64_t column_reallocs = 0;       /* `Column::resize` calls that reallocated */
+		std::uint64_t query_hits = 0;            /* `query` served straight from its cache */
+		std::uint64_t query_updates = 0;         /* `query` patched its cache incrementally */
+		std::uint64_t query_rebuilds = 0;        /* `query` rebuilt its cache from scratch */
+		std::uint64_t components_registered = 0; /* first-time `get_cid` registrations */
+		std::uint64_t hierarchy_rebuilds = 0;    /* `query_hierarchy` resolved its rows again */
+		std::uint64_t rows_resorted = 0;         /* rows `sort_by` displaced and merged back in */
+	};
+
+#ifdef NCS_COUNTERS
+	constexpr bool COUNTERS_ENABLED = true;
+#else
+	constexpr bool COUNTERS_ENABLED = false;
+#endif
+
+	/* counters of the calling thread */
+	Counters& counters();
+
+	void reset_counters();
+}
+
+#ifdef NCS_COUNTERS
+#define NCS_COUNT(counter, n) (::ncs::counters().counter += (n))
+#else
+#define NCS_COUNT(counter, n) ((void) 0)
+#endif
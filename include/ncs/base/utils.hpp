@@ -56,6 +56,23 @@ namespace ncs
 
 	uint64_t archash(const std::vector<Component>& components);
 
+	/* hashes a sorted component signature so it can key a map; lookups still compare the whole signature */
+	struct SignatureHash
+	{
+		std::size_t operator()(const std::vector<Component>& components) const
+		{
+			return archash(components);
+		}
+	};
+
+	/* rough heap footprint of a node-based hash map: the bucket array plus one node per element */
+	template<typename Map>
+	std::size_t map_footprint(const Map& map)
+	{
+		constexpr std::size_t node = sizeof(typename Map::value_type) + 2 * sizeof(void*);
+		return map.bucket_count() * sizeof(void*) + map.size() * node;
+	}
+
 	class InvalidEntityError final : public std::runtime_error
 	{
 	public:
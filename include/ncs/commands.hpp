@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+	class World;
+
+	/*
+	 * structural changes recorded now and applied later, in one batch, by `World::apply()`. a system
+	 * that spawns, adds, removes or despawns in the middle of a query records into a buffer instead,
+	 * so rows stay put while it runs. a buffer belongs to one thread at a time; `spawn()` is the only
+	 * call that touches the world, through the lock-free `World::reserve_entities()`
+	 */
+	class Commands
+	{
+	public:
+		explicit Commands(World &world);
+
+		Commands(Commands &&) noexcept = default;
+
+		Commands &operator=(Commands &&) noexcept = default;
+
+		/* a handle that comes alive when the buffer is applied, holding whatever was `set()` on it */
+		[[nodiscard("ncs::Entity should not be discarded")]]
+		Entity spawn();
+
+		template<typename T>
+		Commands *set(Entity e, T value);
+
+		template<typename T>
+		Commands *remove(Entity e);
+
+		Commands *despawn(Entity e);
+
+		[[nodiscard]] bool empty() const;
+
+		[[nodiscard]] std::size_t size() const;
+
+		/* drops everything recorded; `World::apply()` does this once it is done */
+		void clear();
+
+	private:
+		friend class World;
+
+		enum class Op : std::uint8_t
+		{
+			SET,
+			REMOVE,
+			DESPAWN
+		};
+
+		/* recorded values of one component type */
+		struct Values
+		{
+			virtual ~Values() = default;
+
+			[[nodiscard]] virtual const void *at(std::size_t index) const = 0;
+
+			virtual void clear() = 0;
+		};
+
+		template<typename T>
+		struct TypedValues final : Values
+		{
+			std::vector<T> values;
+
+			[[nodiscard]] const void *at(const std::size_t index) const override
+			{
+				return &values[index];
+			}
+
+			void clear() override
+			{
+				values.clear();
+			}
+		};
+
+		struct Command
+		{
+			Entity entity;
+			Op op;
+			Component (*resolve)(World &) = nullptr; /* the component id, looked up when applied */
+			const Values *values = nullptr;
+			std::size_t index = 0;
+		};
+
+		/* one address per component type; keys `values` without touching the world from a worker thread */
+		template<typename T>
+		static const void *key()
+		{
+			static const char id = 0;
+			return &id;
+		}
+
+		World *world;
+		std::vector<Command> commands;
+		std::unordered_map<const void *, std::unique_ptr<Values> > values;
+	};
+}
@@ -19,6 +19,17 @@ namespace ncs
 		Component id; /* what component causes the transition */
 	};
 
+	/* how archetype storage grows once it runs out of rows */
+	struct GrowthPolicy
+	{
+		size_t initial_rows = 16; /* rows allocated for a fresh archetype */
+		double factor = 2.0;      /* capacity multiplier on every regrow; always grows by at least a row */
+
+		/* storage of newly allocated columns; `mapped_reserve` is the address space each mapped column takes */
+		ColumnBackend backend = ColumnBackend::HEAP;
+		size_t mapped_reserve = size_t { 1 } << 30;
+	};
+
 	struct Record
 	{
 		Archetype* archetype = nullptr;
@@ -37,14 +48,26 @@ namespace ncs
 		std::vector<Entity> entities;
 		size_t entity_count = 0;
 		uint64_t id = 0;
-		DirtyFlags flags = {};
+		uint64_t structure_version = 0; /* bumped whenever rows are added, removed, reordered or reallocated */
+		uint64_t value_version = 0;     /* bumped by in-place writes, which never move a row */
+		GrowthPolicy growth;
+		bool cold = false; /* columns live in files; queries pass the archetype by */
 
 		[[nodiscard]] bool has(Component c) const;
 
 		size_t append(Entity entity);
 
+		/* grows the entity array, every column and the row index to hold at least `rows` rows */
+		void reserve(size_t rows);
+
 		void remove(Entity entity);
 
+		/* moves the row `order[i]` to row `i`; `order` is a permutation of the live rows */
+		void permute(const std::vector<size_t>& order);
+
+		/* trims entity and column storage down to the live rows; returns reclaimed bytes */
+		size_t shrink(size_t min_rows);
+
 		void dump();
 
 		void move(size_t row, Archetype* dest, Entity entity);
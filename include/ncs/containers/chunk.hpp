@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+    /*
+     * one archetype worth of query results laid out as parallel arrays: row `i` of every span belongs to
+     * `entities[i]`. each span is a view straight into its column, so it is contiguous, starts on a
+     * `Column::ALIGNMENT` boundary and stays valid until the next structural change to the archetype
+     */
+    template<typename... Components>
+    struct Chunk
+    {
+        std::span<const Entity> entities; /* raw entity ids, as stored by the archetype */
+        std::tuple<std::span<Components>...> columns;
+        std::size_t count = 0;
+
+        template<typename T>
+        std::span<T> get() const
+        {
+            return std::get<std::span<T> >(columns);
+        }
+    };
+
+    /* a `Chunk` for component sets only known at runtime; `columns[i]` is the start of the i-th column */
+    struct RawChunk
+    {
+        std::span<const Entity> entities;
+        std::vector<void*> columns;
+        std::size_t count = 0;
+
+        template<typename T>
+        std::span<T> get(const std::size_t i) const
+        {
+            return std::span<T>(static_cast<T*>(columns[i]), count);
+        }
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -10,9 +11,20 @@ namespace ncs
     using CopierFn = void(*)(void*, const void*);
     using DestructorFn = void(*)(void*);
 
+    /* where a column keeps its rows */
+    enum class ColumnBackend
+    {
+        HEAP,  /* an aligned heap buffer, copied whenever it regrows */
+        MAPPED, /* a virtual range reserved up front and committed as rows are added; regrowing never copies */
+        FILE    /* a shared mapping of an unlinked file; the kernel pages rows out to it and back in on access */
+    };
+
     class Column
     {
     public:
+        /* every buffer starts on a cache line, so row 0 of any column is safe for aligned vector loads */
+        static constexpr std::size_t ALIGNMENT = 64;
+
         Column() = default;
 
         ~Column();
@@ -27,6 +39,9 @@ namespace ncs
 
         void resize(std::size_t new_cap);
 
+        /* releases capacity past `new_cap`; returns the number of bytes given back */
+        std::size_t shrink(std::size_t new_cap);
+
         void clear();
 
         template<typename T>
@@ -77,10 +92,22 @@ namespace ncs
 
         void destroy_at(std::size_t row);
 
+        /* copy-constructs `count` rows of `src` starting at `src_first` into this column at `dst_first` */
+        void copy_rows(const Column& src, std::size_t src_first, std::size_t dst_first, std::size_t count);
+
+        /* moves row `order[i]` to row `i`; rows past the end of `order` stay where they are */
+        void permute(const std::vector<std::size_t>& order);
+
+        /* copy-constructs `src_row` into the `count` rows starting at `first` */
+        void fill(std::size_t src_row, std::size_t first, std::size_t count);
+
         void load_raw(std::size_t element_size, DestructorFn destructor, CopierFn cp);
 
         void mark_constructed(std::size_t row, bool value = true);
 
+        [[nodiscard]]
+        void* data() const;
+
         [[nodiscard]]
         void* get(std::size_t row) const;
 
@@ -96,6 +123,7 @@ namespace ncs
         template<typename T>
         void load()
         {
+            static_assert(alignof(T) <= ALIGNMENT, "component alignment exceeds the column alignment");
             sz = sizeof(T);
             if constexpr (!std::is_trivially_destructible_v<T>)
             {
@@ -128,6 +156,25 @@ namespace ncs
 
         [[nodiscard]] std::size_t size() const;
 
+        /* bytes held by the element buffer and the construction bitmap */
+        [[nodiscard]] std::size_t reserved_bytes() const;
+
+        /*
+         * picks the backend for storage allocated from now on; a `MAPPED` column reserves `reserve` bytes
+         * of address space, backed by transparent huge pages where the kernel allows it. a `FILE` column
+         * maps at least `reserve` bytes of a file created in `directory`. growing past the reservation
+         * maps a larger range and copies once
+         */
+        void set_backend(ColumnBackend kind, std::size_t reserve, std::string directory = {});
+
+        [[nodiscard]] ColumnBackend get_backend() const;
+
+        /* moves the rows into fresh storage from the current backend */
+        void migrate();
+
+        /* asks the kernel to write a `FILE` column back and drop it from memory; a no-op otherwise */
+        void page_out() const;
+
         [[nodiscard]] bool has_dtor() const;
 
         [[nodiscard]] bool has_copier() const;
@@ -137,6 +184,21 @@ namespace ncs
         [[nodiscard]] bool is_constructed(std::size_t row) const;
 
     private:
+        static void* allocate(std::size_t bytes);
+
+        /* a buffer of at least `bytes` from the current backend; `mapped_bytes` is zero for heap buffers */
+        void* acquire(std::size_t bytes, std::size_t& mapped_bytes) const;
+
+        static void release(void* p, std::size_t mapped_bytes);
+
+        /* makes the first `bytes` of the mapping writable */
+        void commit(std::size_t bytes);
+
+        [[nodiscard]] std::size_t committed_for(std::size_t bytes) const;
+
+        /* moves the first `rows` rows into `new_ptr` and releases the old buffer */
+        void relocate(void* new_ptr, std::size_t rows);
+
         void* ptr = nullptr;
         std::size_t sz = 0;
         std::size_t cap = 0;
@@ -144,6 +206,12 @@ namespace ncs
         CopierFn copier = nullptr;
         DestructorFn dtor = nullptr;
 
+        ColumnBackend backend = ColumnBackend::HEAP;
+        std::size_t reserve_bytes = 0;
+        std::string directory;     /* where `FILE` columns create their backing file */
+        std::size_t mapped = 0;    /* address space reserved at `ptr`; zero for heap buffers */
+        std::size_t committed = 0; /* leading bytes of the mapping that are readable and writable */
+
         std::vector<bool> constructed;
     };
 }
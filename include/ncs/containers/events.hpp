@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace ncs
+{
+    /* hands out the smallest free per-thread index; a thread's index is returned when it exits */
+    class ThreadSlots
+    {
+    public:
+        std::size_t acquire()
+        {
+            std::lock_guard guard(lock);
+            if (free.empty())
+                return next++;
+
+            const auto smallest = std::ranges::min_element(free);
+            const std::size_t slot = *smallest;
+            *smallest = free.back();
+            free.pop_back();
+            return slot;
+        }
+
+        void release(const std::size_t slot)
+        {
+            std::lock_guard guard(lock);
+            free.emplace_back(slot);
+        }
+
+    private:
+        std::mutex lock;
+        std::vector<std::size_t> free;
+        std::size_t next = 0;
+    };
+
+    inline ThreadSlots& thread_slots()
+    {
+        static ThreadSlots slots;
+        return slots;
+    }
+
+    /*
+     * small dense per-thread index, handed out on a thread's first call and recycled once the thread exits.
+     * a later thread that inherits the index also inherits whatever the old one staged; the lock in
+     * `ThreadSlots` orders the two threads' writes
+     */
+    inline std::size_t thread_slot()
+    {
+        struct Lease
+        {
+            std::size_t slot = thread_slots().acquire();
+
+            ~Lease()
+            {
+                thread_slots().release(slot);
+            }
+        };
+
+        thread_local const Lease lease;
+        return lease.slot;
+    }
+
+    /* a reader's position in an event stream; every reader keeps its own */
+    struct EventCursor
+    {
+        std::uint64_t next = 0; /* id of the next event this reader has not seen */
+    };
+
+    /*
+     * double-buffered queue of `T` events. `send()` may be called from any number of threads at once;
+     * every thread appends to its own staging buffer and `update()` merges them at the frame boundary.
+     * merged events stay readable for two frames, after which their buffer is reused
+     *
+     * `update()` and `read()` must not run concurrently with `send()`
+     */
+    template<typename T>
+    class Events
+    {
+    public:
+        static constexpr std::size_t MAX_WRITERS = 64; /* concurrently live threads past this share a locked buffer */
+
+        Events() = default;
+
+        ~Events()
+        {
+            for (auto& stage: stages)
+                delete stage.load(std::memory_order_relaxed);
+        }
+
+        Events(const Events&) = delete;
+
+        Events& operator=(const Events&) = delete;
+
+        void send(const T& event)
+        {
+            if (std::vector<T>* stage = local_stage())
+            {
+                stage->emplace_back(event);
+                return;
+            }
+
+            std::lock_guard lock(overflow_lock);
+            overflow.emplace_back(event);
+        }
+
+        void send(T&& event)
+        {
+            if (std::vector<T>* stage = local_stage())
+            {
+                stage->emplace_back(std::move(event));
+                return;
+            }
+
+            std::lock_guard lock(overflow_lock);
+            overflow.emplace_back(std::move(event));
+        }
+
+        /* frame boundary: retires the oldest frame and publishes everything staged since the last call */
+        void update()
+        {
+            current ^= 1;
+            std::vector<T>& buffer = buffers[current];
+            buffer.clear();
+            starts[current] = count;
+
+            for (auto& slot: stages)
+            {
+                if (std::vector<T>* stage = slot.load(std::memory_order_acquire))
+                {
+                    std::move(stage->begin(), stage->end(), std::back_inserter(buffer));
+                    stage->clear();
+                }
+            }
+
+            std::move(overflow.begin(), overflow.end(), std::back_inserter(buffer));
+            overflow.clear();
+            count += buffer.size();
+        }
+
+        /* visits, oldest first, the events `cursor` has not seen yet and moves it past them */
+        template<typename Fn>
+        std::size_t read(EventCursor& cursor, Fn&& fn) const
+        {
+            std::size_t visited = 0;
+            for (const int i: { current ^ 1, current })
+            {
+                const std::vector<T>& buffer = buffers[i];
+                const std::uint64_t first = std::max(cursor.next, starts[i]);
+                for (std::uint64_t id = first; id < starts[i] + buffer.size(); ++id, ++visited)
+                    fn(buffer[id - starts[i]]);
+            }
+
+            cursor.next = count;
+            return visited;
+        }
+
+        /* a cursor that only sees events published after this call */
+        [[nodiscard]] EventCursor latest() const
+        {
+            return { count };
+        }
+
+        /* events currently readable */
+        [[nodiscard]] std::size_t size() const
+        {
+            return buffers[0].size() + buffers[1].size();
+        }
+
+    private:
+        std::vector<T>* local_stage()
+        {
+            const std::size_t slot = thread_slot();
+            if (slot >= MAX_WRITERS)
+                return nullptr;
+
+            /* only the owning thread ever stores into its slot */
+            std::vector<T>* stage = stages[slot].load(std::memory_order_relaxed);
+            if (!stage)
+            {
+                stage = new std::vector<T>();
+                stages[slot].store(stage, std::memory_order_release);
+            }
+            return stage;
+        }
+
+        std::array<std::vector<T>, 2> buffers;   /* the previous and the current frame */
+        std::array<std::uint64_t, 2> starts = {}; /* id of the first event of each buffer */
+        std::uint64_t count = 0;                  /* ids handed out so far */
+        int current = 0;
+
+        std::array<std::atomic<std::vector<T>*>, MAX_WRITERS> stages = {};
+        std::mutex overflow_lock;
+        std::vector<T> overflow;
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+    /*
+     * which (entity id, component) pairs changed, and at which tick. a pair only keeps its latest stamp,
+     * so writing the same component every tick does not grow the journal, and walking the changes after
+     * some tick touches only the entries stamped since
+     */
+    class ChangeJournal
+    {
+    public:
+        static constexpr Component LIFETIME = ~Component { 0 }; /* the entity itself was spawned or despawned */
+
+        /* stamps `component` of `id` with `tick`; ticks must never go backwards */
+        void record(std::uint64_t tick, std::uint64_t id, Component component);
+
+        /* calls `fn(id, component)` for every pair last changed after `since`, oldest first */
+        template<typename Fn>
+        void visit_since(const std::uint64_t since, Fn&& fn) const
+        {
+            const auto first = std::ranges::partition_point(entries, [since](const Entry& entry)
+            {
+                return entry.tick <= since;
+            });
+
+            for (auto it = first; it != entries.end(); ++it)
+            {
+                if (it->id != STALE)
+                    fn(it->id, it->component);
+            }
+        }
+
+        /* forgets every pair last changed at or before `through`; later visits must not reach back past it */
+        void trim(std::uint64_t through);
+
+        /* the latest tick passed to `trim()` */
+        [[nodiscard]] std::uint64_t floor() const
+        {
+            return trimmed;
+        }
+
+        [[nodiscard]] std::size_t size() const;
+
+    private:
+        static constexpr std::uint64_t STALE = ~std::uint64_t { 0 }; /* superseded by a later stamp */
+
+        struct Entry
+        {
+            std::uint64_t tick;
+            std::uint64_t id;
+            Component component;
+        };
+
+        /* drops superseded entries once they make up half the journal */
+        void compact();
+
+        std::vector<Entry> entries;                           /* ascending by tick */
+        std::unordered_map<std::uint64_t, std::size_t> latest; /* pair key to its live entry */
+        std::size_t stale = 0;
+        std::uint64_t trimmed = 0;
+    };
+}
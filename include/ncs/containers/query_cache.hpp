@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <utility>
+#include <vector>
 #include <ncs/containers/archetype.hpp>
 
 namespace ncs
@@ -8,8 +10,68 @@ namespace ncs
     template<typename... Components>
     struct QueryCache
     {
-        Archetype *archetype = nullptr; /* strong pointer to the archetype */
-        std::size_t entity_count = 0;        /* entity count at the time of caching */
+        /* one matching archetype and the stretch of `result` holding its rows */
+        struct Slice
+        {
+            Archetype *archetype = nullptr;
+            std::uint64_t structure_version = 0; /* `Archetype::structure_version` the rows were read at */
+            std::size_t first = 0;
+            std::size_t count = 0;
+        };
+
+        std::uint64_t archetype_version = 0; /* `World::archetype_version` the slices were collected at */
+        std::vector<Slice> slices;
+        std::vector<std::tuple<Entity, Components *...> > result;
+
+        static std::size_t entries(const void *ptr)
+        {
+            return static_cast<const QueryCache *>(ptr)->result.size();
+        }
+
+        static std::size_t footprint(const void *ptr)
+        {
+            const auto *cache = static_cast<const QueryCache *>(ptr);
+            return sizeof(QueryCache) + cache->result.capacity() * sizeof(typename decltype(result)::value_type) +
+                   cache->slices.capacity() * sizeof(Slice);
+        }
+    };
+
+    /*
+     * a hierarchy query result: rows are ordered breadth-first, `depths[d]` is the first row at depth `d`
+     * and `parents[i]` is the row of the closest ancestor of row `i` that matched, or `NO_PARENT`
+     */
+    template<typename... Components>
+    struct Hierarchy
+    {
+        static constexpr std::size_t NO_PARENT = ~std::size_t { 0 };
+
+        std::uint64_t hierarchy_version = 0; /* versions the rows were resolved against */
+        std::uint64_t archetype_version = 0;
+        std::vector<std::pair<Archetype *, std::uint64_t> > archetypes; /* matching ones and their structure version */
         std::vector<std::tuple<Entity, Components *...> > result;
+        std::vector<std::size_t> parents;
+        std::vector<std::size_t> depths;
+
+        static std::size_t entries(const void *ptr)
+        {
+            return static_cast<const Hierarchy *>(ptr)->result.size();
+        }
+
+        static std::size_t footprint(const void *ptr)
+        {
+            const auto *cache = static_cast<const Hierarchy *>(ptr);
+            return sizeof(Hierarchy) + cache->result.capacity() * sizeof(typename decltype(result)::value_type) +
+                   (cache->parents.capacity() + cache->depths.capacity()) * sizeof(std::size_t) +
+                   cache->archetypes.capacity() * sizeof(typename decltype(archetypes)::value_type);
+        }
+    };
+
+    /* type-erased handle the world keeps for every query cache it owns */
+    struct ErasedQueryCache
+    {
+        void *cache = nullptr;
+        void (*deleter)(void *) = nullptr;
+        std::size_t (*entries)(const void *) = nullptr;
+        std::size_t (*footprint)(const void *) = nullptr;
     };
 }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+	/*
+	 * type-erased observer: receives a batch of entities and a pointer to the first of their components,
+	 * which are laid out contiguously. single-entity operations deliver batches of one
+	 */
+	using ObserverFn = std::function<void(std::span<const Entity>, void *)>;
+
+	struct Observer
+	{
+		std::uint64_t id = 0; /* unique within its world */
+		ObserverFn fn;
+	};
+
+	struct Observers
+	{
+		std::vector<Observer> on_add;
+		std::vector<Observer> on_set;
+		std::vector<Observer> on_remove;
+	};
+
+	/* names a registered observer so it can be dropped again with `World::unobserve()` */
+	struct ObserverHandle
+	{
+		Component component = 0;
+		std::vector<Observer> Observers::*list = nullptr;
+		std::uint64_t id = 0;
+	};
+}
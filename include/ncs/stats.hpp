@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <ncs/types.hpp>
+
+namespace ncs
+{
+	struct ArchetypeStats
+	{
+		std::uint64_t id = 0;
+		std::vector<Component> components;
+		std::size_t entity_count = 0;
+		std::size_t capacity = 0;       /* rows the entity array and columns can hold before regrowing */
+		std::size_t bytes_used = 0;     /* component and entity bytes backing live rows */
+		std::size_t bytes_reserved = 0; /* everything allocated for the rows, live or not */
+		bool cold = false;
+	};
+
+	struct QueryCacheStats
+	{
+		std::uint64_t hash = 0;
+		std::size_t entries = 0;
+		std::size_t bytes = 0;
+	};
+
+	struct EntityPoolStats
+	{
+		std::size_t alive = 0;
+		std::size_t recyclable = 0; /* despawned ids waiting to be handed out again */
+		std::size_t capacity = 0;
+	};
+
+	/*
+	 * a point-in-time memory report. everything is derived from container sizes and capacities,
+	 * nothing walks rows, so taking one costs O(archetypes + columns + query caches)
+	 */
+	struct WorldStats
+	{
+		std::vector<ArchetypeStats> archetypes;
+		std::vector<QueryCacheStats> queries;
+		EntityPoolStats entities;
+
+		std::size_t map_overhead = 0; /* estimated bucket and node bytes of every hash map */
+		std::size_t bytes_used = 0;
+		std::size_t bytes_reserved = 0;
+		std::size_t query_bytes = 0;
+		std::size_t total_bytes = 0;
+	};
+}
@@ -8,47 +8,28 @@ namespace ncs
     using Entity = std::uint64_t;
     using Generation = std::uint16_t;
 
-    enum class DirtyFlags : std::uint64_t
-    {
-        NONE = 0x0,
-        DIRTY = 0x1,
-        ADDED = 0x2,
-        REMOVED = 0x4,
-        UPDATED = 0x8
-    };
-
-    inline DirtyFlags operator|(DirtyFlags a, DirtyFlags b)
+    constexpr Entity NULL_ENTITY = ~Entity { 0 };
+
+    constexpr std::uint64_t ENTITY_MASK = 0x0000FFFFFFFFFFFF; /* 48 lower bits for entity id */
+    constexpr std::uint64_t GENERATION_SHIFT = 48; /* we need to shift 16 bits upper to accommodate the entity bits */
+
+	/*
+	 * relationship component: an entity holding `Pair<R>` is related to `target` through `R`. the
+	 * signature carries one id per relation kind rather than one per target, so a wide hierarchy does
+	 * not split into an archetype per parent
+	 */
+	template<typename Relation>
+	struct Pair
 	{
-		return static_cast<DirtyFlags>(
-			static_cast<uint8_t>(a) | static_cast<uint8_t>(b)
-		);
-	}
+		Entity target = NULL_ENTITY;
+	};
 
-	inline DirtyFlags& operator|=(DirtyFlags& a, DirtyFlags b)
-	{
-		a = a | b;
-		return a;
-	}
-
-	inline DirtyFlags operator&(DirtyFlags a, DirtyFlags b)
-	{
-		return static_cast<DirtyFlags>(
-			static_cast<uint8_t>(a) & static_cast<uint8_t>(b)
-		);
-	}
+	template<typename T>
+	constexpr bool is_pair_v = false;
 
-	inline DirtyFlags& operator&=(DirtyFlags& a, DirtyFlags b)
-	{
-		a = a & b;
-		return a;
-	}
-	inline DirtyFlags operator~(DirtyFlags updated)
-	{
-		return static_cast<DirtyFlags>(~static_cast<uint64_t>(updated));
-	}
+	template<typename Relation>
+	constexpr bool is_pair_v<Pair<Relation> > = true;
 
-	inline bool has_flag(DirtyFlags flags, DirtyFlags flag)
-	{
-		return (static_cast<uint8_t>(flags) & static_cast<uint8_t>(flag)) != 0;
-	}
+	/* the relation that forms the parent/child hierarchy */
+	struct ChildOf {};
 }
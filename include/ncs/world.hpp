@@ -1,15 +1,56 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <ncs/access.hpp>
+#include <ncs/commands.hpp>
+#include <ncs/observer.hpp>
+#include <ncs/stats.hpp>
 #include <ncs/types.hpp>
+#include <ncs/base/counters.hpp>
 #include <ncs/base/utils.hpp>
 #include <ncs/containers/archetype.hpp>
+#include <ncs/containers/chunk.hpp>
+#include <ncs/containers/events.hpp>
+#include <ncs/containers/journal.hpp>
 #include <ncs/containers/query_cache.hpp>
 
 namespace ncs
 {
+	struct CompactionPolicy
+	{
+		bool automatic = false;         /* let `despawn()` call `compact()` on its own */
+		std::size_t interval = 4096;    /* despawns between two automatic passes */
+		std::size_t min_rows = 16;      /* never shrink a column below this many rows */
+		bool release_empty = true;      /* free archetypes that no longer hold any entity */
+	};
+
+	/*
+	 * a component type that only exists at runtime, e.g. one declared by a script. `copy` copy-constructs
+	 * into uninitialised storage and `destroy` ends a lifetime; leave them null for trivially copyable or
+	 * destructible data. columns relocate rows by copying, so there is no separate move hook
+	 */
+	struct ComponentDesc
+	{
+		std::string_view name;  /* registering the same name and layout again yields the same id */
+		std::size_t size = 0;   /* a multiple of `alignment`, as `sizeof` always is */
+		std::size_t alignment = alignof(std::max_align_t); /* a power of two */
+		CopierFn copy = nullptr;
+		DestructorFn destroy = nullptr;
+	};
+
 	class World
 	{
 	public:
@@ -20,8 +61,50 @@ namespace ncs
 		[[nodiscard("ncs::Entity should not be discarded")]]
 		Entity entity();
 
+		/*
+		 * hands out `n` entity handles without locking and may be called from any number of threads at
+		 * once, as long as nothing else mutates the world meanwhile. the handles are valid but hold no
+		 * components until the next sync point: `flush_reserved()`, which `entity()` and `despawn()`
+		 * also run first
+		 */
+		[[nodiscard("ncs::Entity should not be discarded")]]
+		std::vector<Entity> reserve_entities(std::size_t n);
+
+		/* commits every reserved handle to the entity bookkeeping */
+		void flush_reserved();
+
+		/*
+		 * makes room for `n` entities, counted like `std::vector::reserve`: the id bookkeeping always,
+		 * and when `Components` is not empty, the archetype of exactly those components, which is
+		 * created if needed. spawning up to `n` such entities then allocates nothing
+		 */
+		template<typename... Components>
+		World *reserve(std::size_t n);
+
+		/* applies to every archetype, existing ones included; columns switch backend when they next reallocate */
+		void set_growth_policy(const GrowthPolicy &policy);
+
+		/*
+		 * moves the archetype of exactly `Components` out of core: its columns are rehomed into files
+		 * under `directory` and paged back in on access. its entities stay addressable through `get()`,
+		 * `set()` and friends, but `query()` and `chunks()` only visit it when asked to with `include_cold`
+		 */
+		template<typename... Components>
+		World *make_cold(const std::string &directory);
+
+		/* brings a cold archetype back into memory under the current growth policy */
+		template<typename... Components>
+		World *make_hot();
+
 		void despawn(Entity e);
 
+		/*
+		 * spawns `n` copies of `prefab`. the copies land in the prefab's archetype in one go: rows are
+		 * reserved up front and each column is filled straight from the prototype row, without walking
+		 * the archetype graph per copy
+		 */
+		std::vector<Entity> instantiate(Entity prefab, std::size_t n);
+
 		template<typename T>
 		World *set(Entity e, const T &data);
 
@@ -34,20 +117,223 @@ namespace ncs
 		template<typename T>
 		T *get(Entity e);
 
+		/*
+		 * `get()` for many handles at once: `out[i]` receives the `T` of `entities[i]`, or nullptr when
+		 * the handle is dead or lacks `T`. handles are resolved in small batches, prefetching generations
+		 * first and the component rows next, so the cache misses of one batch overlap instead of queuing
+		 */
+		template<typename T>
+		void get_many(std::span<const Entity> entities, std::span<T *> out);
+
 		template<typename T>
 		World *remove(Entity e);
 
+		/*
+		 * plays back deferred commands in one batch. every entity moves at most once, straight to the
+		 * archetype it ends up in, and entities are visited grouped by their source and destination
+		 * archetypes. commands on dead handles are dropped, and so are `ChildOf` pairs whose target is
+		 * dead or that would close a cycle, in the order they were recorded. the buffers are cleared afterwards
+		 */
+		void apply(Commands &commands);
+
+		void apply(std::span<Commands> buffers);
+
+		/* registers a runtime component; it is stored exactly like a templated one */
+		Component register_component(const ComponentDesc &desc);
+
+		/* copies `value` into component `c` of `e`, adding it if needed */
+		World *set_raw(Entity e, Component c, const void *value);
+
+		[[nodiscard]] void *get_raw(Entity e, Component c);
+
+		World *remove_raw(Entity e, Component c);
+
+		/* the runtime counterpart of `chunks()`: column pointers follow the order of `components` */
+		std::vector<RawChunk> query(std::span<const Component> components, bool include_cold = false);
+
+		/*
+		 * every entity holding `Components...`, those of cold archetypes only with `include_cold`. the
+		 * result is cached per query and per `include_cold`, and refreshed lazily; the refresh is
+		 * serialised, so systems that only read may call it from several threads at once as long as
+		 * `Components...` were registered beforehand (as building their `Access` does)
+		 */
+		template<typename... Components>
+		std::vector<std::tuple<Entity, Components *...> > query(bool include_cold = false);
+
+		/*
+		 * like `query()` but yields whole archetypes as aligned component arrays, ready for SIMD kernels.
+		 * cold archetypes are only visited with `include_cold`
+		 */
 		template<typename... Components>
-		std::vector<std::tuple<Entity, Components *...> > query();
+		std::vector<Chunk<Components...> > chunks(bool include_cold = false);
+
+		/*
+		 * physically reorders the rows of every archetype holding `T` so that `cmp` holds between
+		 * neighbouring rows; later `query()` and `chunks()` calls walk each archetype in that order.
+		 * rows that are already in place are kept, only the displaced ones are sorted and merged back,
+		 * so re-sorting after k changed keys costs O(n + k log k) rather than a full sort
+		 */
+		template<typename T, typename Cmp = std::less<T> >
+		World *sort_by(Cmp cmp = {});
+
+		/*
+		 * gives unused capacity back to the allocator: columns are trimmed down to their live rows,
+		 * empty archetypes are released together with every graph edge leading to them and query
+		 * caches are dropped so they are rebuilt against the new layout. returns the reclaimed bytes
+		 */
+		std::size_t compact();
+
+		void set_compaction_policy(const CompactionPolicy &policy);
+
+		/*
+		 * component lifecycle observers. `fn` is either `void(Entity, T *)`, called once per entity, or
+		 * `void(std::span<const Entity>, std::span<T>)`, called once per batch; bulk operations such as
+		 * `instantiate()` deliver their rows as a single batch. `on_add` fires when `T` is attached,
+		 * `on_set` after every write through `set()` (including the first) and `on_remove` right before
+		 * `T` is destroyed by `remove()` or `despawn()`. the returned handle unregisters the observer
+		 */
+		template<typename T, typename Fn>
+		ObserverHandle on_add(Fn &&fn);
+
+		template<typename T, typename Fn>
+		ObserverHandle on_set(Fn &&fn);
+
+		template<typename T, typename Fn>
+		ObserverHandle on_remove(Fn &&fn);
+
+		/* drops the observer behind `handle`; a no-op if it is already gone. never call it from an observer */
+		void unobserve(const ObserverHandle &handle);
+
+		/*
+		 * moves every entity of `other` into this world; `other` may have been filled on another thread,
+		 * e.g. while streaming a level in. archetypes this world already has receive the rows as bulk
+		 * column appends, the others are adopted as a whole. entity ids are remapped in one batch and
+		 * `Pair<R>` targets and the `ChildOf` hierarchy follow the remapping. resources, events and
+		 * observers of `other` are not carried over, and `other` is only good for destruction afterwards
+		 */
+		void merge(World &&other);
+
+		/*
+		 * a compact binary stream of everything that changed after tick `since`: entities spawned and
+		 * despawned, components added, written and removed, each written component with its current
+		 * bytes. `diff_since(0)` is a full snapshot for an empty replica. the first call turns change
+		 * tracking on, so worlds that never replicate pay nothing for it; from then on building a diff
+		 * costs in proportion to what changed rather than to the size of the world.
+		 * only trivially copyable components are carried. writes through pointers from `get()`,
+		 * `query()` or `chunks()` are only seen once announced with `touch()`
+		 *
+		 * passing `since` acknowledges everything up to it: the journal forgets those changes, and asking
+		 * for an older tick than the last one acknowledged afterwards throws `std::invalid_argument`; a replica that
+		 * fell that far behind starts over from `diff_since(0)`
+		 */
+		std::vector<std::byte> diff_since(std::uint64_t since);
+
+		/* the tick closed by the last `diff_since()`; passing it to the next call yields only newer changes */
+		[[nodiscard]] std::uint64_t tick() const
+		{
+			return change_tick - 1;
+		}
+
+		/*
+		 * replays a stream from another world's `diff_since()`. entities keep their ids and generations,
+		 * so a replica should not spawn entities of its own. the stream names its components by type (or
+		 * by the name they were registered under), so registration order does not matter, but the replica
+		 * must know every component the stream writes, with the same size. returns the tick the stream
+		 * was closed at
+		 */
+		std::uint64_t apply_diff(std::span<const std::byte> diff);
+
+		/* announces a write to `T` of `e` made through a pointer; `on_set` observers fire and the next diff carries it */
+		template<typename T>
+		World *touch(Entity e);
+
+		/*
+		 * relates `e` to `target` through `R`; an entity holds at most one target per relation.
+		 * `target` must be alive, and a `ChildOf` pair must not make `e` its own ancestor
+		 */
+		template<typename R>
+		World *pair(Entity e, Entity target);
+
+		/* the target `e` is related to through `R`, or `NULL_ENTITY` */
+		template<typename R>
+		Entity target(Entity e);
+
+		template<typename R>
+		World *unpair(Entity e);
+
+		/* despawns `e` together with everything below it in the `ChildOf` hierarchy */
+		void despawn_recursive(Entity e);
+
+		/*
+		 * entities of the `ChildOf` hierarchy that hold `Components...`, visited breadth-first so every
+		 * parent comes before its children. the ordering and the resolved rows are cached and only
+		 * resolved again after the hierarchy changes or rows of a matching archetype move, so work on
+		 * unrelated archetypes leaves the cache alone; the reference stays valid until the next call
+		 * that rebuilds it
+		 */
+		template<typename... Components>
+		const Hierarchy<Components...> &query_hierarchy();
+
+		[[nodiscard]] WorldStats stats() const;
+
+		/* stores a singleton, replacing any previous one of the same type */
+		template<typename T, typename... Args>
+		T &set_resource(Args &&... args);
+
+		/* the singleton of type `T`, or nullptr; a bounds check and a single load */
+		template<typename T>
+		T *resource();
+
+		template<typename T>
+		void remove_resource();
+
+		/* the `T` event queue of this world; created on first use and kept as an `Events<T>` resource */
+		template<typename T>
+		Events<T> &events();
+
+		/* frame boundary for every event queue; see `Events<T>::update()` */
+		void update_events();
+
+		/* dense process-wide index of resource type `T`, as used by `Access` */
+		template<typename T>
+		static std::size_t resource_id()
+		{
+			static const std::size_t id = next_resource_id();
+			return id;
+		}
+
+		/* builds the access declaration of a system from `Read`, `Write`, `ReadResource` and `WriteResource` terms */
+		template<typename... Terms>
+		Access access();
+
+		/* whether `e` names a live entity; a stale handle of a despawned or recycled id reports false */
+		[[nodiscard]] bool is_alive(const Entity e) const
+		{
+			const std::uint64_t id = get_eid(e);
+			return id < generations.size() && generations[id] == (get_egen(e) | ALIVE);
+		}
 
 		/* utils */
-		static Entity encode_entity(std::uint64_t eid, Generation egen);
+		static Entity encode_entity(const std::uint64_t eid, const Generation egen)
+		{
+			return (static_cast<Entity>(egen) << GENERATION_SHIFT) | (eid & ENTITY_MASK);
+		}
 
-		static std::uint64_t get_eid(Entity e);
+		static std::uint64_t get_eid(const Entity e)
+		{
+			return e & ENTITY_MASK;
+		}
 
-		static Generation get_egen(Entity e);
+		static Generation get_egen(const Entity e)
+		{
+			return static_cast<Generation>(e >> GENERATION_SHIFT);
+		}
 
 	private:
+		friend class Commands;
+
+		static constexpr std::uint32_t ALIVE = 1u << 16; /* above every 16-bit generation */
+
 		/*
 		 * this may seem unnerving at first, but it is valid. for every unique `T`
 		 * the compiler will generate a separate instantiation of `type_hash<T>()`.
@@ -76,8 +362,10 @@ namespace ncs
 				return it->second;
 			}
 
+			NCS_COUNT(components_registered, 1);
 			const Component id = next_cid++;
 			component_types[th] = id;
+			component_keys.emplace_back(std::string("t") + typeid(T).name());
 			component_sizes[id] = sizeof(T);
 			if constexpr (!std::is_trivially_destructible_v<T>)
 			{
@@ -86,9 +374,25 @@ namespace ncs
 					static_cast<T *>(ptr)->~T();
 				};
 			}
+			if constexpr (!std::is_trivially_copyable_v<T>)
+			{
+				ccopiers[id] = [](void *dst, const void *src)
+				{
+					std::construct_at(static_cast<T *>(dst), *static_cast<const T *>(src));
+				};
+			}
+			if constexpr (is_pair_v<T>)
+				relation_cids.insert(id);
 			return id;
 		}
 
+		/* `get_cid<T>()` as a plain function pointer, for `Commands` to resolve ids when they are applied */
+		template<typename T>
+		static Component cid_of(World &world)
+		{
+			return world.get_cid<T>();
+		}
+
 		template<typename T>
 		T *get_component_ptr(Archetype *archetype, const size_t row)
 		{
@@ -107,22 +411,158 @@ namespace ncs
 
 		void move_entity(Entity entity, Record &record, Archetype *destination);
 
-		std::unordered_map<std::uint64_t, Archetype *> archetypes;
+		void patch_swapped(Archetype *archetype, size_t row);
+
+		[[nodiscard]] Generation recycled_generation(std::uint64_t id) const;
+
+		[[nodiscard]] Generation generation_of(const std::uint64_t id) const
+		{
+			return static_cast<Generation>(generations[id]);
+		}
+
+		void mark_alive(std::uint64_t id, Generation gen);
+
+		/* records `child` under `parent`; refused, returning false, when it would close a `ChildOf` cycle */
+		bool link(std::uint64_t child, std::uint64_t parent);
+
+		/* whether `ancestor` is `id` itself or sits above it in the `ChildOf` hierarchy */
+		[[nodiscard]] bool is_ancestor(std::uint64_t ancestor, std::uint64_t id) const;
+
+		/* throws unless `parent` is alive and would not make `child` its own ancestor */
+		void check_parent(Entity child, Entity parent) const;
+
+		/* the id of `Pair<ChildOf>`, looked up without registering it; `ChangeJournal::LIFETIME` if unknown */
+		[[nodiscard]] Component childof_cid() const;
+
+		void unlink(std::uint64_t child);
+
+		void rebuild_hierarchy();
+
+		static std::size_t next_resource_id();
+
+		template<typename T, typename Fn>
+		static ObserverFn wrap_observer(Fn &&fn)
+		{
+			if constexpr (std::is_invocable_v<Fn &, std::span<const Entity>, std::span<T> >)
+			{
+				return [fn = std::forward<Fn>(fn)](const std::span<const Entity> entities, void *first) mutable
+				{
+					fn(entities, std::span<T>(static_cast<T *>(first), entities.size()));
+				};
+			}
+			else
+			{
+				return [fn = std::forward<Fn>(fn)](const std::span<const Entity> entities, void *first) mutable
+				{
+					for (std::size_t i = 0; i < entities.size(); ++i)
+						fn(entities[i], static_cast<T *>(first) + i);
+				};
+			}
+		}
+
+		Observers &observers_of(Component cid);
+
+		template<typename T, typename Fn>
+		ObserverHandle observe(std::vector<Observer> Observers::*which, Fn &&fn);
+
+		/* fires `which` observers of `cid`; a size check when nobody listens */
+		void notify(std::vector<Observer> Observers::*which, const Component cid,
+		            const std::span<const Entity> entities, void *first)
+		{
+			if (tracking)
+				track(cid, entities);
+
+			if (cid >= observers.size() || (observers[cid].*which).empty())
+				return;
+
+			for (Observer &observer: observers[cid].*which)
+				observer.fn(entities, first);
+		}
+
+		template<typename T>
+		void declare(Access &out, Read<T> *)
+		{
+			out.reads.emplace_back(get_cid<T>());
+		}
+
+		template<typename T>
+		void declare(Access &out, Write<T> *)
+		{
+			out.writes.emplace_back(get_cid<T>());
+		}
+
+		template<typename T>
+		void declare(Access &out, ReadResource<T> *)
+		{
+			out.resource_reads.emplace_back(resource_id<T>());
+		}
+
+		template<typename T>
+		void declare(Access &out, WriteResource<T> *)
+		{
+			out.resource_writes.emplace_back(resource_id<T>());
+		}
+
+		void invalidate_queries();
+
+		void reserve_ids(std::size_t n);
+
+		void set_cold(Archetype *archetype, bool cold, const std::string &directory);
+
+		/* stamps `cid` of `entities` in the change journal */
+		void track(Component cid, std::span<const Entity> entities);
+
+		/* brings `e` to life under its exact id and generation, replacing an older generation of the id */
+		void adopt(Entity e);
+
+		/* keyed by the sorted signature; equal hashes still fall back to comparing the full signature */
+		std::unordered_map<std::vector<Component>, Archetype *, SignatureHash> archetypes;
+		GrowthPolicy growth = {}; /* declared ahead of `root_archetype`, which is created from it */
 		std::unordered_map<Entity, Record> entity_records;
 		std::unordered_map<Component, void(*)(void *)> cdtors;
-		std::unordered_map<std::uint64_t, std::pair<void *, void(*)(void *)> > qcaches; /* type-erased query caches */
-
-		std::unordered_map<Entity, Generation> generations; /* a sparse set to track decoded entity's id */
+		std::unordered_map<Component, CopierFn> ccopiers;
+		std::unordered_map<std::uint64_t, ErasedQueryCache> qcaches; /* type-erased query caches */
+		std::unordered_map<std::uint64_t, ErasedQueryCache> hcaches; /* type-erased hierarchy query caches */
+		std::mutex cache_lock; /* held while a query looks up or refreshes its cache */
+
+		/* the `ChildOf` hierarchy, by raw entity id */
+		std::unordered_map<std::uint64_t, std::uint64_t> parent_of;
+		std::unordered_map<std::uint64_t, std::vector<std::uint64_t> > children_of;
+		std::vector<std::uint64_t> hierarchy_order;  /* ids in breadth-first order */
+		std::vector<std::size_t> hierarchy_depths;   /* where each depth starts in `hierarchy_order` */
+		std::uint64_t hierarchy_version = 1;
+		std::uint64_t hierarchy_built = 0;
+		std::uint64_t archetype_version = 1;         /* bumped whenever an archetype is created or released */
+
+		/* indexed by entity id: the current generation, with `ALIVE` set while the id is in use */
+		std::vector<std::uint32_t> generations;
 		/* maps entity ids to their index poses in the entity pools */
 		std::unordered_map<uint64_t, size_t> entity_indices;
 		std::unordered_map<std::uint64_t, Component> component_types; /* map component type to component id */
+		std::unordered_map<std::string, Component> component_names;   /* runtime components, by name */
+		std::vector<std::string> component_keys; /* indexed by component id: what names it across worlds */
+		std::unordered_set<Component> relation_cids;                  /* ids of `Pair<R>` components */
 		std::unordered_map<Component, size_t> component_sizes;        /* stores size of each component type */
+		std::unordered_map<Component, size_t> component_alignments;   /* runtime components only */
 
 		std::vector<Entity> entity_pool; /* available ids */
+		std::vector<std::pair<void *, void(*)(void *)> > resources; /* indexed by `resource_id<T>()` */
+		std::vector<Observers> observers;                            /* indexed by component id */
+		std::uint64_t next_observer = 1;
+		std::vector<std::pair<std::size_t, void(*)(void *)> > event_queues; /* resource id of a queue and its `update()` */
+
+		ChangeJournal journal;
+		std::uint64_t change_tick = 1; /* stamp of changes made since the last `diff_since()` */
+		bool tracking = false;
+
+		CompactionPolicy compaction = {};
+		std::size_t despawns_since_compact = 0;
 
 		Archetype *root_archetype = {}; /* */
 		uint64_t alive_count;           /* the current number of alive & active entity */
-		uint64_t next_eid;              /* next entity id */
+		std::atomic<uint64_t> next_eid; /* next entity id; bumped concurrently by `reserve_entities` */
+		std::atomic<int64_t> free_cursor = 0; /* dead pool slots not yet claimed by `reserve_entities` */
+		uint64_t committed_eid = 0;     /* `next_eid` as of the last sync point */
 		uint16_t next_cid;              /* next component id */
 	};
 
@@ -130,15 +570,12 @@ namespace ncs
 	World *World::set(const Entity e, const T &data)
 	{
 		const std::uint64_t entity_id = get_eid(e);
-#ifndef NDEBUG
 		/* if it is valid; */
-		const Generation gen = get_egen(e);
-		if (const auto it = generations.find(entity_id);
-			it == generations.end() || it->second != gen)
-		{
+		if (!is_alive(e))
 			return this;
-		}
-#endif
+		/* the hierarchy is kept beside the component; `set_raw()` keeps the two in step */
+		if constexpr (std::is_same_v<T, Pair<ChildOf> >)
+			return set_raw(e, get_cid<T>(), &data);
 
 		const Component component_id = get_cid<T>();
 		if (const auto record_it = entity_records.find(entity_id); /* check if entity exists in any archetype */
@@ -153,7 +590,7 @@ namespace ncs
 			{
 				column.load<T>();
 				if (row >= column.capacity())
-					column.resize(std::max(size_t { 16 }, row + 1));
+					column.resize(std::max(growth.initial_rows, row + 1));
 			}
 
 			if (row >= column.capacity())
@@ -163,6 +600,9 @@ namespace ncs
 			column.construct_at<T>(row, data);
 
 			entity_records[entity_id] = { dst, row }; /* make a new record */
+
+			notify(&Observers::on_add, component_id, { &e, 1 }, column.get(row));
+			notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 		}
 		else /* path 2: entity exists in the archetype */
 		{
@@ -180,7 +620,8 @@ namespace ncs
 				column.destroy_at(row);
 				column.construct_at<T>(row, data);
 
-				current->flags |= DirtyFlags::UPDATED;
+				++current->value_version;
+				notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 			}
 			else
 			{
@@ -189,7 +630,7 @@ namespace ncs
 				if (column.size() == 0) /* setup col if not */
 				{
 					column.load<T>();
-					column.resize(std::max(size_t { 16 }, destination->entities.size()));
+					column.resize(std::max(growth.initial_rows, destination->entities.size()));
 				}
 				move_entity(entity_id, record, destination);
 
@@ -199,6 +640,9 @@ namespace ncs
 
 				/* construct the component in the new archetype */
 				column.construct_at<T>(row, data);
+
+				notify(&Observers::on_add, component_id, { &e, 1 }, column.get(row));
+				notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 			}
 		}
 
@@ -209,15 +653,12 @@ namespace ncs
 	World *World::set(Entity e, T &&data)
 	{
 		const uint64_t entity_id = get_eid(e);
-#ifndef NDEBUG
 		/* if it is valid; */
-		const Generation gen = get_egen(e);
-		if (const auto it = generations.find(entity_id);
-			it == generations.end() || it->second != gen)
-		{
-			throw InvalidEntityError(entity_id, gen, __FILE__, __LINE__);
-		}
-#endif
+		if (!is_alive(e))
+			throw InvalidEntityError(entity_id, get_egen(e), __FILE__, __LINE__);
+		/* the hierarchy is kept beside the component; `set_raw()` keeps the two in step */
+		if constexpr (std::is_same_v<std::remove_cvref_t<T>, Pair<ChildOf> >)
+			return set_raw(e, get_cid<Pair<ChildOf> >(), &data);
 
 		const Component component_id = get_cid<T>();
 		if (const auto record_it = entity_records.find(entity_id); /* check if entity exists in any archetype */
@@ -232,7 +673,7 @@ namespace ncs
 			{
 				column.load<std::remove_reference_t<T> >();
 				if (row >= column.capacity())
-					column.resize(std::max(size_t { 16 }, row + 1));
+					column.resize(std::max(growth.initial_rows, row + 1));
 			}
 
 			if (row >= column.capacity())
@@ -242,6 +683,9 @@ namespace ncs
 			column.construct_at<std::remove_reference_t<T> >(row, std::forward<T>(data));
 
 			entity_records[entity_id] = { dst, row }; /* make a new record */
+
+			notify(&Observers::on_add, component_id, { &e, 1 }, column.get(row));
+			notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 		}
 		else /* path 2: entity exists in the archetype */
 		{
@@ -258,7 +702,8 @@ namespace ncs
 				column.destroy_at(row);
 				column.construct_at<std::remove_reference_t<T> >(row, std::forward<T>(data));
 
-				current->flags |= DirtyFlags::UPDATED;
+				++current->value_version;
+				notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 			}
 			else
 			{
@@ -267,7 +712,7 @@ namespace ncs
 				if (column.size() == 0) /* setup col if not */
 				{
 					column.load<std::remove_reference_t<T> >();
-					column.resize(std::max(size_t { 16 }, destination->entities.size()));
+					column.resize(std::max(growth.initial_rows, destination->entities.size()));
 				}
 				move_entity(entity_id, record, destination);
 
@@ -277,6 +722,9 @@ namespace ncs
 
 				/* construct the component in the new archetype with perfect forwarding */
 				column.construct_at<std::remove_reference_t<T> >(row, std::forward<T>(data));
+
+				notify(&Observers::on_add, component_id, { &e, 1 }, column.get(row));
+				notify(&Observers::on_set, component_id, { &e, 1 }, column.get(row));
 			}
 		}
 
@@ -287,15 +735,9 @@ namespace ncs
 	T *World::get(const Entity e)
 	{
 		const uint64_t entity_id = get_eid(e);
-#ifndef NDEBUG
 		/* if it is valid; */
-		const Generation gen = get_egen(e);
-		if (const auto it = generations.find(entity_id);
-			it == generations.end() || it->second != gen)
-		{
-			throw InvalidEntityError(entity_id, gen, __FILE__, __LINE__);
-		}
-#endif
+		if (!is_alive(e))
+			throw InvalidEntityError(entity_id, get_egen(e), __FILE__, __LINE__);
 
 		const Component component_id = get_cid<T>();
 		const auto it = entity_records.find(entity_id);
@@ -311,18 +753,70 @@ namespace ncs
 		return column.get_as<T>(row);
 	}
 
+	template<typename T>
+	void World::get_many(const std::span<const Entity> entities, const std::span<T *> out)
+	{
+		if (out.size() < entities.size())
+			throw std::invalid_argument("get_many output is shorter than its input");
+
+		constexpr std::size_t BATCH = 16;
+		const Component component_id = get_cid<T>();
+		std::array<const Column *, BATCH> columns;
+		std::array<std::size_t, BATCH> rows;
+
+		/* neighbouring handles tend to share an archetype; its column is looked up once per run */
+		const Archetype *last = nullptr;
+		const Column *column = nullptr;
+
+		for (std::size_t base = 0; base < entities.size(); base += BATCH)
+		{
+			const std::size_t count = std::min(BATCH, entities.size() - base);
+			const Entity *batch = entities.data() + base;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (const std::uint64_t id = get_eid(batch[i]); id < generations.size())
+					__builtin_prefetch(&generations[id]);
+			}
+
+			/* the records are independent lookups, so their misses overlap as well */
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				columns[i] = nullptr;
+				if (!is_alive(batch[i]))
+					continue;
+
+				const auto it = entity_records.find(get_eid(batch[i]));
+				if (it == entity_records.end())
+					continue;
+
+				if (const Archetype *arch = it->second.archetype; arch != last)
+				{
+					last = arch;
+					const auto col = arch->columns.find(component_id);
+					column = col == arch->columns.end() ? nullptr : &col->second;
+				}
+				if (!column)
+					continue;
+
+				columns[i] = column;
+				rows[i] = it->second.row;
+				__builtin_prefetch(column->get(rows[i]));
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+				out[base + i] = columns[i] ? columns[i]->get_as<T>(rows[i]) : nullptr;
+		}
+	}
+
 	template<typename T>
 	bool World::has(const Entity e)
 	{
 	    const uint64_t entity_id = get_eid(e);
-		const Generation gen = get_egen(e);
 
 		/* if it is valid; this is required */
-	    if (const auto it = generations.find(entity_id);
-			it == generations.end() || it->second != gen)
-	    {
+	    if (!is_alive(e))
 		    return false;
-	    }
 
 	    const Component component_id = get_cid<T>();
 	    const auto it = entity_records.find(entity_id);
@@ -336,133 +830,346 @@ namespace ncs
 	template<typename T>
 	World *World::remove(const Entity e)
 	{
-		const uint64_t entity_id = get_eid(e);
-
-#ifndef NDEBUG
-		/* if it is valid; */
-		const Generation gen = get_egen(e);
-		if (const auto it = generations.find(entity_id);
-			it == generations.end() || it->second != gen)
-		{
-			throw InvalidEntityError(entity_id, gen, __FILE__, __LINE__);
-		}
-#endif
+		return remove_raw(e, get_cid<T>());
+	}
 
-		const Component component_id = get_cid<T>();
-		const auto it = entity_records.find(entity_id);
-		if (it == entity_records.end())
-			return this;
+	template<typename T>
+	World *World::touch(const Entity e)
+	{
+		if (T *value = get<T>(e))
+			notify(&Observers::on_set, get_cid<T>(), { &e, 1 }, value);
+		return this;
+	}
 
-		Record &record = it->second;
-		Archetype *current = record.archetype;
-		if (!current->has(component_id))
-			return this;
+	template<typename... Components>
+	World *World::make_cold(const std::string &directory)
+	{
+		set_cold(create_archetype({ get_cid<Components>()... }), true, directory);
+		return this;
+	}
 
-		/* destroy the component if it's constructed */
-		Column &column = current->columns[component_id];
-		if (column.is_constructed(record.row))
-			column.destroy_at(record.row);
+	template<typename... Components>
+	World *World::make_hot()
+	{
+		if (Archetype *archetype = find_archetype({ get_cid<Components>()... }))
+			set_cold(archetype, false, {});
+		return this;
+	}
 
-		Archetype *dst = find_archetype_without(current, component_id);
-		move_entity(entity_id, record, dst);
+	template<typename... Components>
+	World *World::reserve(const std::size_t n)
+	{
+		reserve_ids(n);
+		if constexpr (sizeof...(Components) > 0)
+			create_archetype({ get_cid<Components>()... })->reserve(n);
 		return this;
 	}
 
 	template<typename... Components>
-	std::vector<std::tuple<Entity, Components *...> > World::query()
+	std::vector<std::tuple<Entity, Components *...> > World::query(const bool include_cold)
 	{
-		const std::vector<Component> cids = { get_cid<Components>()... };
-		const uint64_t qhash = archash(cids);
+		using Cache = QueryCache<Components...>;
+
+		/* keyed by the cache type itself: a hash collision can never hand back a cache of another type */
+		const uint64_t qkey = include_cold ? type_hash<std::pair<Cache, std::true_type> >() : type_hash<Cache>();
+		std::lock_guard guard(cache_lock);
 
-		auto cache_it = qcaches.find(qhash);
-		QueryCache<Components...> *cache = nullptr;
+		Cache *cache = nullptr;
+		if (const auto cache_it = qcaches.find(qkey);
+			cache_it != qcaches.end())
+		{
+			cache = static_cast<Cache *>(cache_it->second.cache);
+		}
+		else
+		{
+			cache = new Cache();
+			qcaches[qkey] = {
+				cache,
+				[](void *ptr)
+				{
+					delete static_cast<Cache *>(ptr);
+				},
+				&Cache::entries,
+				&Cache::footprint
+			};
+		}
 
-		if (cache_it != qcaches.end())
+		/* the set of archetypes changed; collect the matching ones again */
+		const bool rebuild = cache->archetype_version != archetype_version;
+		if (rebuild)
 		{
-			cache = static_cast<QueryCache<Components...> *>(cache_it->second.first);
-			if (cache->archetype && cache->entity_count == cache->archetype->entity_count &&
-			    !has_flag(cache->archetype->flags, DirtyFlags::ADDED | DirtyFlags::REMOVED | DirtyFlags::UPDATED))
+			NCS_COUNT(query_rebuilds, 1);
+			const Component cids[] = { get_cid<Components>()... };
+
+			cache->slices.clear();
+			for (const auto &[signature, arch]: archetypes)
 			{
-				return cache->result;
+				if ((include_cold || !arch->cold) &&
+				    std::ranges::all_of(cids, [arch](const Component cid) { return arch->has(cid); }))
+					cache->slices.push_back({ arch, ~std::uint64_t { 0 }, 0, 0 });
 			}
+			cache->archetype_version = archetype_version;
+		}
+
+		/* only archetypes whose rows moved are read again; value writes never bump the structure version */
+		auto dirty = std::ranges::find_if(cache->slices, [](const typename Cache::Slice &slice)
+		{
+			return slice.archetype->structure_version != slice.structure_version;
+		});
+		if (dirty == cache->slices.end())
+		{
+			NCS_COUNT(query_hits, 1);
+			return cache->result;
+		}
+		if (!rebuild)
+			NCS_COUNT(query_updates, 1);
 
-			if (cache->archetype)
+		/* slices before the first stale one keep their place in `result` */
+		std::vector<std::tuple<Entity, Components *...> > refreshed;
+		refreshed.reserve(cache->result.size());
+		refreshed.insert(refreshed.end(), cache->result.begin(), cache->result.begin() +
+		                 static_cast<std::ptrdiff_t>(dirty->first));
+
+		for (auto it = dirty; it != cache->slices.end(); ++it)
+		{
+			Archetype *arch = it->archetype;
+			const size_t first = refreshed.size();
+			if (arch->structure_version == it->structure_version)
+			{
+				const auto from = cache->result.begin() + static_cast<std::ptrdiff_t>(it->first);
+				refreshed.insert(refreshed.end(), from, from + static_cast<std::ptrdiff_t>(it->count));
+			}
+			else
 			{
-				if (has_flag(cache->archetype->flags, DirtyFlags::ADDED) &&
-				    !has_flag(cache->archetype->flags, DirtyFlags::REMOVED | DirtyFlags::UPDATED))
+				/* rows are dense, so every pointer is a column base plus the row */
+				const std::tuple<Components *...> bases = {
+					static_cast<Components *>(arch->columns.at(get_cid<Components>()).data())...
+				};
+				for (size_t row = 0; row < arch->entity_count; ++row)
 				{
-					/* append the new entities */
-					for (size_t i = cache->entity_count; i < cache->archetype->entity_count; ++i)
-					{
-						Entity entity_id = cache->archetype->entities[i];
-						const auto gen_it = generations.find(entity_id);
-						if (gen_it == generations.end())
-							continue;
-
-						Entity encoded_entity = encode_entity(entity_id, gen_it->second);
-						cache->result.emplace_back(std::make_tuple(
-							encoded_entity,
-							get_component_ptr<Components>(cache->archetype, i)...
-						));
-					}
-					cache->entity_count = cache->archetype->entity_count;
-					cache->archetype->flags = static_cast<DirtyFlags>(
-						static_cast<uint64_t>(cache->archetype->flags) &
-						~static_cast<uint64_t>(DirtyFlags::ADDED) /* reset the flag */
-					);
-					return cache->result;
+					const Entity entity_id = arch->entities[row];
+					refreshed.emplace_back(encode_entity(entity_id, generation_of(entity_id)),
+					                       std::get<Components *>(bases) + row...);
 				}
+				it->structure_version = arch->structure_version;
+			}
+			it->first = first;
+			it->count = refreshed.size() - first;
+		}
+
+		cache->result = std::move(refreshed);
+		return cache->result;
+	}
+
+	template<typename T, typename Cmp>
+	World *World::sort_by(Cmp cmp)
+	{
+		const Component cid = get_cid<T>();
+
+		std::vector<size_t> order, displaced;
+		for (const auto &[hash, archetype]: archetypes)
+		{
+			if (archetype->entity_count < 2 || !archetype->has(cid))
+				continue;
+
+			const auto &column = archetype->columns[cid];
+			const auto less = [&column, &cmp](const size_t a, const size_t b)
+			{
+				return cmp(*static_cast<const T *>(column.get(a)), *static_cast<const T *>(column.get(b)));
+			};
 
-				if (has_flag(cache->archetype->flags, DirtyFlags::REMOVED) &&
-				    !has_flag(cache->archetype->flags, DirtyFlags::ADDED | DirtyFlags::UPDATED))
+			/*
+			 * keep the rows that already ascend and displace the ones out of place. when a row falls below
+			 * the last kept one, either that kept row was raised (the new row still fits after the one
+			 * before it, so the kept row goes) or the new row was lowered (it goes itself); a single changed
+			 * key therefore displaces a single row
+			 */
+			order.clear();
+			displaced.clear();
+			for (size_t row = 0; row < archetype->entity_count; ++row)
+			{
+				if (order.empty() || !less(row, order.back()))
+				{
+					order.emplace_back(row);
+				}
+				else if (order.size() == 1 || !less(row, order[order.size() - 2]))
 				{
-					/* filter out non-existent entities; entities were removed */
-					auto &result = cache->result;
-					result.erase(
-						std::remove_if(result.begin(), result.end(),
-						               [this, cache](const auto &tuple)
-						               {
-							               Entity encoded_entity = std::get<0>(tuple);
-							               uint64_t entity_id = get_eid(encoded_entity);
-							               return cache->archetype->entity_rows.find(entity_id) == cache->archetype->
-							                      entity_rows.end();
-						               }),
-						result.end()
-					);
-					cache->entity_count = cache->archetype->entity_count;
-					cache->archetype->flags = static_cast<DirtyFlags>(
-						static_cast<uint64_t>(cache->archetype->flags) &
-						~static_cast<uint64_t>(DirtyFlags::REMOVED) /* reset the flag */
-					);
-					return cache->result;
+					displaced.emplace_back(order.back());
+					order.back() = row;
 				}
-				if (has_flag(cache->archetype->flags, DirtyFlags::UPDATED))
+				else
 				{
-					cache->archetype->flags = static_cast<DirtyFlags>(
-						static_cast<uint64_t>(cache->archetype->flags) &
-						~static_cast<uint64_t>(DirtyFlags::UPDATED)
-					);
+					displaced.emplace_back(row);
 				}
 			}
+
+			if (displaced.empty())
+				continue;
+			NCS_COUNT(rows_resorted, displaced.size());
+
+			const auto kept = static_cast<std::ptrdiff_t>(order.size());
+			std::ranges::sort(displaced, less);
+			order.insert(order.end(), displaced.begin(), displaced.end());
+			std::inplace_merge(order.begin(), order.begin() + kept, order.end(), less);
+
+			archetype->permute(order);
+			for (size_t row = 0; row < archetype->entity_count; ++row)
+				entity_records[archetype->entities[row]].row = row;
+		}
+
+		/* query caches, hierarchies included, notice the new structure versions on their own */
+		return this;
+	}
+
+	template<typename... Components>
+	std::vector<Chunk<Components...> > World::chunks(const bool include_cold)
+	{
+		const Component cids[] = { get_cid<Components>()... };
+
+		std::vector<Chunk<Components...> > result;
+		for (const auto &[hash, arch]: archetypes)
+		{
+			if (arch->entity_count == 0 || (arch->cold && !include_cold))
+				continue;
+
+			auto valid = true;
+			for (const Component cid: cids)
+			{
+				if (!arch->has(cid))
+				{
+					valid = false;
+					break;
+				}
+			}
+
+			if (!valid)
+				continue;
+
+			Chunk<Components...> &chunk = result.emplace_back();
+			chunk.count = arch->entity_count;
+			chunk.entities = std::span<const Entity>(arch->entities.data(), arch->entity_count);
+			chunk.columns = std::make_tuple(std::span<Components>(
+				static_cast<Components *>(arch->columns.at(get_cid<Components>()).data()), arch->entity_count)...);
+		}
+
+		return result;
+	}
+
+	template<typename R>
+	World *World::pair(const Entity e, const Entity target)
+	{
+		if (!is_alive(target))
+			throw InvalidEntityError(get_eid(target), get_egen(target), __FILE__, __LINE__);
+		return set<Pair<R> >(e, Pair<R> { target });
+	}
+
+	template<typename R>
+	Entity World::target(const Entity e)
+	{
+		const Pair<R> *pair = get<Pair<R> >(e);
+		return pair ? pair->target : NULL_ENTITY;
+	}
+
+	template<typename R>
+	World *World::unpair(const Entity e)
+	{
+		return remove<Pair<R> >(e);
+	}
+
+	template<typename... Components>
+	const Hierarchy<Components...> &World::query_hierarchy()
+	{
+		std::lock_guard guard(cache_lock);
+		if (hierarchy_built != hierarchy_version)
+			rebuild_hierarchy();
+
+		const std::vector<Component> cids = { get_cid<Components>()... };
+		const uint64_t qkey = type_hash<Hierarchy<Components...> >();
+		const auto matches = [&cids](const Archetype *arch)
+		{
+			return std::ranges::all_of(cids, [arch](const Component cid) { return arch->has(cid); });
+		};
+
+		Hierarchy<Components...> *cache = nullptr;
+		if (const auto cache_it = hcaches.find(qkey);
+			cache_it != hcaches.end())
+		{
+			/* rows only need resolving again once one of the matching archetypes was restructured */
+			cache = static_cast<Hierarchy<Components...> *>(cache_it->second.cache);
+			bool fresh = cache->hierarchy_version == hierarchy_version &&
+			             std::ranges::all_of(cache->archetypes, [](const auto &seen)
+			             {
+				             return seen.first->structure_version == seen.second;
+			             });
+
+			/* releasing an archetype drops every cache, so only new archetypes can be missing */
+			if (fresh && cache->archetype_version != archetype_version)
+			{
+				fresh = static_cast<std::size_t>(std::ranges::count_if(archetypes, [&matches](const auto &entry)
+				{
+					return matches(entry.second);
+				})) == cache->archetypes.size();
+				cache->archetype_version = archetype_version;
+			}
+			if (fresh)
+				return *cache;
 		}
 		else
 		{
-			cache = new QueryCache<Components...>();
-			qcaches[qhash] = {
+			cache = new Hierarchy<Components...>();
+			hcaches[qkey] = {
 				cache,
 				[](void *ptr)
 				{
-					delete static_cast<QueryCache<Components...> *>(ptr);
-				}
+					delete static_cast<Hierarchy<Components...> *>(ptr);
+				},
+				&Hierarchy<Components...>::entries,
+				&Hierarchy<Components...>::footprint
 			};
 		}
 
-		/* clear existing results if this is a cache rebuild */
-		std::vector<std::tuple<Entity, Components *...> >().swap(cache->result);
+		cache->result.clear();
+		cache->parents.clear();
+		cache->depths.clear();
+		NCS_COUNT(hierarchy_rebuilds, 1);
+		cache->archetypes.clear();
+		cache->hierarchy_version = hierarchy_version;
+		cache->archetype_version = archetype_version;
+		for (const auto &[signature, arch]: archetypes)
+		{
+			if (matches(arch))
+				cache->archetypes.emplace_back(arch, arch->structure_version);
+		}
 
-		/* populate the query */
-		for (const auto &[hash, arch]: archetypes)
+		/* closest matching ancestor row of every visited id; non-matching nodes pass theirs down */
+		std::unordered_map<std::uint64_t, std::size_t> nearest;
+		nearest.reserve(hierarchy_order.size());
+
+		std::size_t depth = 0;
+		for (std::size_t i = 0; i < hierarchy_order.size(); ++i)
 		{
+			if (depth < hierarchy_depths.size() && hierarchy_depths[depth] == i)
+			{
+				cache->depths.emplace_back(cache->result.size());
+				++depth;
+			}
+
+			const std::uint64_t id = hierarchy_order[i];
+			std::size_t parent_row = Hierarchy<Components...>::NO_PARENT;
+			if (const auto parent_it = parent_of.find(id);
+				parent_it != parent_of.end())
+			{
+				if (const auto row_it = nearest.find(parent_it->second);
+					row_it != nearest.end())
+					parent_row = row_it->second;
+			}
+			nearest[id] = parent_row;
+
+			const auto record_it = entity_records.find(id);
+			if (record_it == entity_records.end())
+				continue;
+
+			auto &[arch, row] = record_it->second;
 			auto valid = true;
 			for (const Component cid: cids)
 			{
@@ -476,24 +1183,122 @@ namespace ncs
 			if (!valid)
 				continue;
 
-			/* patch & cache the result */
-			cache->archetype = arch;
-			cache->entity_count = arch->entity_count;
-			for (size_t i = 0; i < arch->entity_count; ++i)
-			{
-				Entity entity_id = arch->entities[i];
-				const auto gen_it = generations.find(entity_id);
-				if (gen_it == generations.end())
-					continue;
+			nearest[id] = cache->result.size();
+			cache->parents.emplace_back(parent_row);
+			cache->result.emplace_back(encode_entity(id, generation_of(id)), get_component_ptr<Components>(arch, row)...);
+		}
 
-				Entity encoded_entity = encode_entity(entity_id, gen_it->second);
-				cache->result.emplace_back(std::make_tuple(
-					encoded_entity,
-					get_component_ptr<Components>(arch, i)...
-				));
-			}
+		return *cache;
+	}
+
+	template<typename T, typename... Args>
+	T &World::set_resource(Args &&... args)
+	{
+		const std::size_t id = resource_id<T>();
+		if (id >= resources.size())
+			resources.resize(id + 1, { nullptr, nullptr });
+
+		auto &[ptr, del] = resources[id];
+		if (ptr)
+			del(ptr);
+
+		ptr = new T(std::forward<Args>(args)...);
+		del = [](void *p)
+		{
+			delete static_cast<T *>(p);
+		};
+		return *static_cast<T *>(ptr);
+	}
+
+	template<typename T>
+	T *World::resource()
+	{
+		const std::size_t id = resource_id<T>();
+		return id < resources.size() ? static_cast<T *>(resources[id].first) : nullptr;
+	}
+
+	template<typename T>
+	void World::remove_resource()
+	{
+		const std::size_t id = resource_id<T>();
+		if (id >= resources.size() || !resources[id].first)
+			return;
+
+		auto &[ptr, del] = resources[id];
+		del(ptr);
+		ptr = nullptr;
+		del = nullptr;
+	}
+
+	template<typename... Terms>
+	Access World::access()
+	{
+		Access out;
+		(declare(out, static_cast<Terms *>(nullptr)), ...);
+		return out;
+	}
+
+	template<typename T, typename Fn>
+	ObserverHandle World::observe(std::vector<Observer> Observers::*which, Fn &&fn)
+	{
+		const ObserverHandle handle = { get_cid<T>(), which, next_observer++ };
+		(observers_of(handle.component).*which).push_back({ handle.id, wrap_observer<T>(std::forward<Fn>(fn)) });
+		return handle;
+	}
+
+	template<typename T, typename Fn>
+	ObserverHandle World::on_add(Fn &&fn)
+	{
+		return observe<T>(&Observers::on_add, std::forward<Fn>(fn));
+	}
+
+	template<typename T, typename Fn>
+	ObserverHandle World::on_set(Fn &&fn)
+	{
+		return observe<T>(&Observers::on_set, std::forward<Fn>(fn));
+	}
+
+	template<typename T, typename Fn>
+	ObserverHandle World::on_remove(Fn &&fn)
+	{
+		return observe<T>(&Observers::on_remove, std::forward<Fn>(fn));
+	}
+
+	template<typename T>
+	Events<T> &World::events()
+	{
+		if (Events<T> *queue = resource<Events<T> >())
+			return *queue;
+
+		/* the queue is looked up again on every update, so a removed or replaced resource never dangles */
+		const std::size_t id = resource_id<Events<T> >();
+		if (std::ranges::none_of(event_queues, [id](const auto &queue) { return queue.first == id; }))
+		{
+			event_queues.emplace_back(id, [](void *ptr)
+			{
+				static_cast<Events<T> *>(ptr)->update();
+			});
 		}
+		return set_resource<Events<T> >();
+	}
 
-		return cache->result;
+	template<typename T>
+	Commands *Commands::set(const Entity e, T value)
+	{
+		auto &stored = values[key<T>()];
+		if (!stored)
+			stored = std::make_unique<TypedValues<T> >();
+
+		auto &typed = static_cast<TypedValues<T> &>(*stored);
+		typed.values.emplace_back(std::move(value));
+		commands.push_back({ e, Op::SET, &World::cid_of<T>, stored.get(), typed.values.size() - 1 });
+		return this;
+	}
+
+	template<typename T>
+	Commands *Commands::remove(const Entity e)
+	{
+		commands.push_back({ e, Op::REMOVE, &World::cid_of<T> });
+		return this;
 	}
 }
@@ -0,0 +1,22 @@
+#include <algorithm>
+#include <ncs/access.hpp>
+
+namespace ncs
+{
+	template<typename T>
+	static bool overlaps(const std::vector<T>& a, const std::vector<T>& b)
+	{
+		return std::ranges::any_of(a, [&b](const T& id)
+		{
+			return std::ranges::find(b, id) != b.end();
+		});
+	}
+
+	bool Access::conflicts(const Access& other) const
+	{
+		return overlaps(writes, other.writes) || overlaps(writes, other.reads) || overlaps(reads, other.writes) ||
+		       overlaps(resource_writes, other.resource_writes) ||
+		       overlaps(resource_writes, other.resource_reads) ||
+		       overlaps(resource_reads, other.resource_writes);
+	}
+}
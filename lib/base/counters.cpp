@@ -0,0 +1,16 @@
+#include <ncs/base/counters.hpp>
+
+namespace ncs
+{
+	thread_local Counters local_counters;
+
+	Counters& counters()
+	{
+		return local_counters;
+	}
+
+	void reset_counters()
+	{
+		local_counters = {};
+	}
+}
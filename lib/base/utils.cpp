@@ -1,29 +1,49 @@
+#include <cstring>
 #include <ncs/base/utils.hpp>
 
-/* NOTE: a faster hash algorithm can be used here instead of FNV-1a which is used for simplicity
- * by the time this is written */
 namespace ncs
 {
-	/* hash parameters */
-	constexpr auto FNV_PRIME = 1099511628211ULL;
-	constexpr auto FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	/* multiply-xorshift constants (splitmix64 / murmur3 finaliser) */
+	constexpr uint64_t MIX_MUL = 0x9E3779B97F4A7C15ULL;
+	constexpr uint64_t FMIX_MUL1 = 0xFF51AFD7ED558CCDULL;
+	constexpr uint64_t FMIX_MUL2 = 0xC4CEB9FE1A85EC53ULL;
+
+	static uint64_t mix(uint64_t hash, const uint64_t word)
+	{
+		hash = (hash ^ word) * MIX_MUL;
+		return hash ^ (hash >> 29);
+	}
 
 	uint64_t archash(const std::vector<Component>& components)
 	{
 		if (components.empty())
 			return 0; /* special case for empty vectors */
 
-		uint64_t hash = FNV_OFFSET_BASIS;
-		for (const Component comp : components)
+		/* four component ids per 64-bit word; the length goes into the seed so zero padding cannot alias */
+		constexpr size_t PER_WORD = sizeof(uint64_t) / sizeof(Component);
+		const size_t n = components.size();
+		uint64_t hash = n * MIX_MUL;
+
+		size_t i = 0;
+		for (; i + PER_WORD <= n; i += PER_WORD)
+		{
+			uint64_t word;
+			std::memcpy(&word, components.data() + i, sizeof(word));
+			hash = mix(hash, word);
+		}
+
+		if (i < n)
 		{
-			const auto* bytes = reinterpret_cast<const uint8_t*>(&comp);
-			for (size_t i = 0; i < sizeof(Component); ++i)
-			{
-				hash ^= bytes[i];
-				hash *= FNV_PRIME;
-			}
+			uint64_t word = 0;
+			std::memcpy(&word, components.data() + i, (n - i) * sizeof(Component));
+			hash = mix(hash, word);
 		}
 
+		hash ^= hash >> 33;
+		hash *= FMIX_MUL1;
+		hash ^= hash >> 33;
+		hash *= FMIX_MUL2;
+		hash ^= hash >> 33;
 		return hash;
 	}
 }
@@ -0,0 +1,35 @@
+#include <ncs/commands.hpp>
+#include <ncs/world.hpp>
+
+namespace ncs
+{
+	Commands::Commands(World &world) : world(&world) {}
+
+	Entity Commands::spawn()
+	{
+		return world->reserve_entities(1).front();
+	}
+
+	Commands *Commands::despawn(const Entity e)
+	{
+		commands.push_back({ e, Op::DESPAWN });
+		return this;
+	}
+
+	bool Commands::empty() const
+	{
+		return commands.empty();
+	}
+
+	std::size_t Commands::size() const
+	{
+		return commands.size();
+	}
+
+	void Commands::clear()
+	{
+		commands.clear();
+		for (auto &[type, stored]: values)
+			stored->clear();
+	}
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <bit>
 #include <cstring>
 #include <iostream>
 #include <ncs/containers/archetype.hpp>
@@ -10,7 +11,9 @@ namespace ncs
 		const size_t row = entity_count++;
 		if (row >= entities.size())
 		{
-			const size_t newsz = entities.empty() ? 16 : entities.size() * 2;
+			const auto grown = static_cast<size_t>(static_cast<double>(entities.size()) * growth.factor);
+			const size_t newsz = entities.empty() ? std::max<size_t>(growth.initial_rows, 1)
+			                                      : std::max(grown, entities.size() + 1);
 			entities.resize(newsz);
 			for (auto &[comp_id, column]: columns)
 				column.resize(newsz);
@@ -18,10 +21,22 @@ namespace ncs
 
 		entities[row] = entity;
 		entity_rows[entity] = row;
-		flags |= DirtyFlags::ADDED;
+		++structure_version;
 		return row;
 	}
 
+	void Archetype::reserve(const size_t rows)
+	{
+		if (rows <= entities.size())
+			return;
+
+		entities.resize(rows);
+		for (auto &[comp_id, column]: columns)
+			column.resize(rows);
+		entity_rows.reserve(rows);
+		++structure_version;
+	}
+
 	bool Archetype::has(const Component c) const
 	{
 		return std::ranges::find(components, c) != components.end();
@@ -81,7 +96,48 @@ namespace ncs
 	    entity_count--;
 	    entity_rows.erase(entity);
 	    entities[last_row] = 0;
-	    flags |= DirtyFlags::REMOVED; /* mark as removed */
+	    ++structure_version;
+	}
+
+	void Archetype::permute(const std::vector<size_t>& order)
+	{
+		for (auto &[comp_id, column]: columns)
+			column.permute(order);
+
+		std::vector<Entity> reordered(entities.size());
+		for (size_t row = 0; row < order.size(); ++row)
+		{
+			reordered[row] = entities[order[row]];
+			entity_rows[reordered[row]] = row;
+		}
+		entities = std::move(reordered);
+		++structure_version;
+	}
+
+	size_t Archetype::shrink(const size_t min_rows)
+	{
+		/* keep the next power of two above the live rows so a steady state does not regrow right away */
+		const size_t target = std::max(entity_count == 0 ? 0 : std::bit_ceil(entity_count), min_rows);
+
+		size_t reclaimed = 0;
+		for (auto &[comp_id, column]: columns)
+			reclaimed += column.shrink(target);
+		if (reclaimed > 0)
+			++structure_version; /* columns were reallocated */
+
+		if (target < entities.capacity())
+		{
+			reclaimed += (entities.capacity() - target) * sizeof(Entity);
+			entities.resize(target);
+			entities.shrink_to_fit();
+		}
+
+		const size_t buckets = entity_rows.bucket_count();
+		entity_rows.rehash(0);
+		if (entity_rows.bucket_count() < buckets)
+			reclaimed += (buckets - entity_rows.bucket_count()) * sizeof(void*);
+
+		return reclaimed;
 	}
 
 	void Archetype::dump()
@@ -117,7 +173,7 @@ namespace ncs
 			std::cout << ")" << std::endl;
 		}
 
-		std::cout << "  flags: " << static_cast<uint64_t>(flags) << std::endl;
+		std::cout << "  versions: structure " << structure_version << ", value " << value_version << std::endl;
 	}
 
     void Archetype::move(const size_t row, Archetype* dest, const Entity entity)
@@ -1,10 +1,31 @@
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <cerrno>
+#include <fcntl.h>
+#include <new>
+#include <system_error>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <ncs/base/counters.hpp>
 #include <ncs/containers/column.hpp>
 
 namespace ncs
 {
+    constexpr std::size_t HUGE_PAGE = std::size_t { 2 } << 20; /* 2 MiB transparent huge pages */
+
+    static std::size_t page_size()
+    {
+        static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    static std::size_t round_up(const std::size_t value, const std::size_t to)
+    {
+        return (value + to - 1) / to * to;
+    }
+
     Column::~Column()
     {
         if (ptr && dtor)
@@ -18,19 +39,19 @@ namespace ncs
 
         if (ptr)
         {
-            std::free(ptr);
+            release(ptr, mapped);
             ptr = nullptr;
         }
     }
 
     Column::Column(const Column &other) :
-        sz(other.sz), cap(other.cap), copier(other.copier), dtor(other.dtor)
+        sz(other.sz), cap(other.cap), copier(other.copier), dtor(other.dtor),
+        backend(other.backend), reserve_bytes(other.reserve_bytes), directory(other.directory)
     {
         if (other.ptr && other.cap > 0)
         {
-            ptr = std::malloc(other.cap * sz);
-            if (!ptr)
-                throw std::bad_alloc();
+            ptr = acquire(other.cap * sz, mapped);
+            committed = committed_for(other.cap * sz);
 
             constructed = other.constructed;
 
@@ -58,11 +79,15 @@ namespace ncs
     Column::Column(Column &&other) noexcept :
         ptr(other.ptr), sz(other.sz), cap(other.cap),
         copier(other.copier), dtor(other.dtor),
+        backend(other.backend), reserve_bytes(other.reserve_bytes), directory(std::move(other.directory)),
+        mapped(other.mapped), committed(other.committed),
         constructed(std::move(other.constructed))
     {
         other.ptr = nullptr;
         other.sz = 0;
         other.cap = 0;
+        other.mapped = 0;
+        other.committed = 0;
         other.dtor = nullptr;
         other.copier = nullptr;
     }
@@ -77,12 +102,14 @@ namespace ncs
             dtor = other.dtor;
             copier = other.copier;
             cap = other.cap;
+            backend = other.backend;
+            reserve_bytes = other.reserve_bytes;
+            directory = other.directory;
 
             if (other.ptr && other.cap > 0)
             {
-                ptr = std::malloc(sz * other.cap);
-                if (!ptr)
-                    throw std::bad_alloc();
+                ptr = acquire(sz * other.cap, mapped);
+                committed = committed_for(sz * other.cap);
 
                 constructed = other.constructed;
 
@@ -118,11 +145,18 @@ namespace ncs
             cap = other.cap;
             dtor = other.dtor;
             copier = other.copier;
+            backend = other.backend;
+            reserve_bytes = other.reserve_bytes;
+            directory = std::move(other.directory);
+            mapped = other.mapped;
+            committed = other.committed;
             constructed = std::move(other.constructed);
 
             other.ptr = nullptr;
             other.sz = 0;
             other.cap = 0;
+            other.mapped = 0;
+            other.committed = 0;
             other.dtor = nullptr;
             other.copier = nullptr;
         }
@@ -134,15 +168,173 @@ namespace ncs
         if (new_cap <= cap)
             return;
 
-        void* new_ptr = std::malloc(sz * new_cap);
-        if (!new_ptr)
+        /* a mapped column grows in place by committing more of its range; nothing is copied */
+        if (mapped > 0 && sz * new_cap <= mapped)
+        {
+            commit(sz * new_cap);
+            cap = new_cap;
+            if (constructed.size() < new_cap)
+                constructed.resize(new_cap, false);
+            return;
+        }
+
+        std::size_t new_mapped = 0;
+        void* new_ptr = acquire(sz * new_cap, new_mapped);
+        NCS_COUNT(column_reallocs, 1);
+        relocate(new_ptr, cap);
+        mapped = new_mapped;
+        committed = committed_for(sz * new_cap);
+        cap = new_cap;
+        if (constructed.size() < new_cap)
+            constructed.resize(new_cap, false);
+    }
+
+    std::size_t Column::shrink(const std::size_t new_cap)
+    {
+        if (new_cap >= cap)
+            return 0;
+
+        /* rows past the new end are dead; make sure nothing outlives its storage */
+        if (ptr && dtor)
+        {
+            for (std::size_t i = new_cap; i < cap && i < constructed.size(); ++i)
+            {
+                if (constructed[i])
+                    dtor(static_cast<char*>(ptr) + (i * sz));
+            }
+        }
+
+        const std::size_t reclaimed = (cap - new_cap) * sz + (cap - new_cap) / 8;
+        if (mapped > 0 && new_cap > 0)
+        {
+            /* hand the tail pages back but keep the range, so regrowing stays copy-free */
+            const std::size_t keep = round_up(sz * new_cap, page_size());
+            if (keep < committed)
+            {
+                madvise(static_cast<char*>(ptr) + keep, committed - keep, MADV_DONTNEED);
+                mprotect(static_cast<char*>(ptr) + keep, committed - keep, PROT_NONE);
+                committed = keep;
+            }
+        }
+        else
+        {
+            std::size_t new_mapped = 0;
+            void* new_ptr = new_cap > 0 ? acquire(sz * new_cap, new_mapped) : nullptr;
+            relocate(new_ptr, new_cap);
+            mapped = new_mapped;
+            committed = committed_for(sz * new_cap);
+        }
+        cap = new_cap;
+        constructed.resize(new_cap);
+        constructed.shrink_to_fit();
+        return reclaimed;
+    }
+
+    void* Column::allocate(const std::size_t bytes)
+    {
+        /* `aligned_alloc` wants a multiple of the alignment; memory comes back through `std::free` */
+        const std::size_t rounded = (std::max<std::size_t>(bytes, 1) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        void* p = std::aligned_alloc(ALIGNMENT, rounded);
+        if (!p)
             throw std::bad_alloc();
+        return p;
+    }
+
+    void* Column::acquire(const std::size_t bytes, std::size_t& mapped_bytes) const
+    {
+        mapped_bytes = 0;
+        if (backend == ColumnBackend::HEAP)
+            return allocate(bytes);
 
-        if (ptr && cap > 0)
+        if (backend == ColumnBackend::FILE)
+        {
+            std::string path = (directory.empty() ? std::string("/tmp") : directory) + "/ncs-column-XXXXXX";
+            const int fd = mkstemp(path.data());
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "cannot create a column file");
+            unlink(path.c_str()); /* the mapping keeps the file alive; nothing is left behind */
+
+            const std::size_t length = round_up(std::max({ bytes, reserve_bytes, std::size_t { 1 } }), page_size());
+            if (ftruncate(fd, static_cast<off_t>(length)) != 0)
+            {
+                const int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "cannot size a column file");
+            }
+
+            void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED)
+                throw std::bad_alloc();
+
+            mapped_bytes = length;
+            return base;
+        }
+
+        /* over-reserve by a huge page so the range can start on a huge-page boundary */
+        const std::size_t length = round_up(std::max(bytes, reserve_bytes), HUGE_PAGE);
+        void* raw = mmap(nullptr, length + HUGE_PAGE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc();
+
+        const auto start = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t aligned = round_up(start, HUGE_PAGE);
+        if (aligned > start)
+            munmap(raw, aligned - start);
+        if (const std::uintptr_t tail = start + length + HUGE_PAGE - (aligned + length); tail > 0)
+            munmap(reinterpret_cast<void*>(aligned + length), tail);
+
+        void* base = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(base, length, MADV_HUGEPAGE); /* only a hint; the range works without transparent huge pages */
+#endif
+        if (bytes > 0 && mprotect(base, round_up(bytes, page_size()), PROT_READ | PROT_WRITE) != 0)
+        {
+            munmap(base, length);
+            throw std::bad_alloc();
+        }
+
+        mapped_bytes = length;
+        return base;
+    }
+
+    void Column::release(void* p, const std::size_t mapped_bytes)
+    {
+        if (!p)
+            return;
+
+        if (mapped_bytes > 0)
+            munmap(p, mapped_bytes);
+        else
+            std::free(p);
+    }
+
+    void Column::commit(const std::size_t bytes)
+    {
+        const std::size_t target = round_up(bytes, page_size());
+        if (target <= committed)
+            return;
+
+        if (mprotect(static_cast<char*>(ptr) + committed, target - committed, PROT_READ | PROT_WRITE) != 0)
+            throw std::bad_alloc();
+        committed = target;
+    }
+
+    std::size_t Column::committed_for(const std::size_t bytes) const
+    {
+        /* a file mapping is writable end to end from the start */
+        if (backend == ColumnBackend::FILE)
+            return mapped;
+        return mapped > 0 ? round_up(bytes, page_size()) : 0;
+    }
+
+    void Column::relocate(void* new_ptr, const std::size_t rows)
+    {
+        if (ptr && rows > 0)
         {
             if (copier)
             {
-                for (size_t i = 0; i < cap && i < constructed.size(); ++i)
+                for (size_t i = 0; i < rows && i < constructed.size(); ++i)
                 {
                     if (constructed[i])
                     {
@@ -154,33 +346,24 @@ namespace ncs
             }
             else
             {
-                std::memcpy(new_ptr, ptr, sz * cap);
+                std::memcpy(new_ptr, ptr, sz * rows);
             }
 
-            void* old_ptr = ptr;
-            ptr = new_ptr;
             if (dtor)
             {
-                for (size_t i = 0; i < cap && i < constructed.size(); ++i)
+                for (size_t i = 0; i < rows && i < constructed.size(); ++i)
                 {
                     if (constructed[i])
                     {
-                        void* p = static_cast<char*>(old_ptr) + (i * sz);
+                        void* p = static_cast<char*>(ptr) + (i * sz);
                         dtor(p);
                     }
                 }
             }
-
-            std::free(old_ptr);
-        }
-        else
-        {
-            ptr = new_ptr;
         }
 
-        cap = new_cap;
-        if (constructed.size() < new_cap)
-            constructed.resize(new_cap, false);
+        release(ptr, mapped);
+        ptr = new_ptr;
     }
 
     void Column::clear()
@@ -199,14 +382,21 @@ namespace ncs
 
         if (ptr)
         {
-            std::free(ptr);
+            release(ptr, mapped);
             ptr = nullptr;
         }
 
         cap = 0;
+        mapped = 0;
+        committed = 0;
         constructed.clear();
     }
 
+    void* Column::data() const
+    {
+        return ptr;
+    }
+
     void* Column::get(const std::size_t row) const
     {
         if (row >= cap || !ptr)
@@ -224,6 +414,124 @@ namespace ncs
         }
     }
 
+    void Column::copy_rows(const Column& src, const std::size_t src_first, const std::size_t dst_first,
+                           const std::size_t count)
+    {
+        if (count == 0)
+            return;
+
+        if (dst_first + count > cap)
+            resize(dst_first + count);
+
+        for (std::size_t i = 0; i < count; ++i)
+            destroy_at(dst_first + i);
+
+        if (copier)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (src.is_constructed(src_first + i))
+                    copier(get(dst_first + i), src.get(src_first + i));
+            }
+        }
+        else
+        {
+            std::memcpy(get(dst_first), src.get(src_first), count * sz);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            constructed[dst_first + i] = src.is_constructed(src_first + i);
+    }
+
+    void Column::permute(const std::vector<std::size_t>& order)
+    {
+        if (!ptr || order.empty())
+            return;
+
+        /*
+         * follow each cycle of the permutation in place, parking its first row in a scratch row, so the
+         * backing (heap buffer, reservation or file) is kept. rows of a typical size park on the stack
+         */
+        alignas(ALIGNMENT) std::byte local[256];
+        void* scratch = sz <= sizeof(local) ? local : allocate(sz);
+
+        const auto relocate = [this](void* dst, void* src)
+        {
+            if (copier)
+                copier(dst, src);
+            else
+                std::memcpy(dst, src, sz);
+            if (dtor)
+                dtor(src);
+        };
+
+        std::vector<bool> visited(order.size(), false);
+        std::vector<bool> placed = constructed;
+        for (std::size_t start = 0; start < order.size(); ++start)
+        {
+            if (visited[start])
+                continue;
+            visited[start] = true;
+            if (order[start] == start)
+                continue;
+
+            const bool held = constructed[start];
+            if (held)
+                relocate(scratch, get(start));
+
+            std::size_t row = start;
+            for (std::size_t src = order[row]; src != start; row = src, src = order[row])
+            {
+                visited[src] = true;
+                if (constructed[src])
+                    relocate(get(row), get(src));
+                placed[row] = constructed[src];
+            }
+
+            if (held)
+                relocate(get(row), scratch);
+            placed[row] = held;
+        }
+
+        if (scratch != local)
+            release(scratch, 0);
+        constructed = std::move(placed);
+    }
+
+    void Column::fill(const std::size_t src_row, const std::size_t first, const std::size_t count)
+    {
+        if (count == 0 || !is_constructed(src_row))
+            return;
+
+        if (first + count > cap)
+            resize(first + count);
+
+        char* base = static_cast<char*>(ptr);
+        const char* src = base + (src_row * sz);
+        if (copier)
+        {
+            for (std::size_t row = first; row < first + count; ++row)
+            {
+                destroy_at(row);
+                copier(base + (row * sz), src);
+            }
+        }
+        else
+        {
+            /* seed one row, then keep doubling the filled range */
+            std::memcpy(base + (first * sz), src, sz);
+            for (std::size_t done = 1; done < count;)
+            {
+                const std::size_t chunk = std::min(done, count - done);
+                std::memcpy(base + ((first + done) * sz), base + (first * sz), chunk * sz);
+                done += chunk;
+            }
+        }
+
+        std::fill(constructed.begin() + static_cast<std::ptrdiff_t>(first),
+                  constructed.begin() + static_cast<std::ptrdiff_t>(first + count), true);
+    }
+
     void Column::load_raw(const std::size_t element_size, DestructorFn destructor, const CopierFn cp)
     {
         sz = element_size;
@@ -248,6 +556,43 @@ namespace ncs
         return sz;
     }
 
+    std::size_t Column::reserved_bytes() const
+    {
+        return (mapped > 0 ? committed : cap * sz) + constructed.capacity() / 8;
+    }
+
+    void Column::set_backend(const ColumnBackend kind, const std::size_t reserve, std::string dir)
+    {
+        backend = kind;
+        reserve_bytes = reserve;
+        directory = std::move(dir);
+    }
+
+    void Column::migrate()
+    {
+        if (!ptr || cap == 0)
+            return;
+
+        std::size_t new_mapped = 0;
+        void* new_ptr = acquire(sz * cap, new_mapped);
+        relocate(new_ptr, cap);
+        mapped = new_mapped;
+        committed = committed_for(sz * cap);
+    }
+
+    void Column::page_out() const
+    {
+#ifdef MADV_PAGEOUT
+        if (ptr && backend == ColumnBackend::FILE)
+            madvise(ptr, mapped, MADV_PAGEOUT);
+#endif
+    }
+
+    ColumnBackend Column::get_backend() const
+    {
+        return backend;
+    }
+
     bool Column::has_dtor() const
     {
         return dtor != nullptr;
@@ -0,0 +1,66 @@
+#include <ncs/containers/journal.hpp>
+
+namespace ncs
+{
+    static std::uint64_t key(const std::uint64_t id, const Component component)
+    {
+        /* ids take 48 bits, leaving the low 16 for the component */
+        return id << 16 | component;
+    }
+
+    void ChangeJournal::record(const std::uint64_t tick, const std::uint64_t id, const Component component)
+    {
+        const auto [it, inserted] = latest.try_emplace(key(id, component), entries.size());
+        if (!inserted)
+        {
+            Entry& previous = entries[it->second];
+            if (previous.tick == tick)
+                return; /* already stamped this tick */
+
+            previous.id = STALE;
+            ++stale;
+            it->second = entries.size();
+        }
+
+        entries.push_back({ tick, id, component });
+        if (stale > 64 && stale * 2 > entries.size())
+            compact();
+    }
+
+    void ChangeJournal::trim(const std::uint64_t through)
+    {
+        if (through <= trimmed)
+            return;
+        trimmed = through;
+
+        const auto first = std::ranges::partition_point(entries, [through](const Entry& entry)
+        {
+            return entry.tick <= through;
+        });
+        for (auto it = entries.begin(); it != first; ++it)
+        {
+            if (it->id == STALE)
+                --stale;
+            else
+                latest.erase(key(it->id, it->component));
+        }
+
+        const auto dropped = static_cast<std::size_t>(first - entries.begin());
+        entries.erase(entries.begin(), first);
+        for (auto& [pair, index]: latest)
+            index -= dropped;
+    }
+
+    std::size_t ChangeJournal::size() const
+    {
+        return entries.size() - stale;
+    }
+
+    void ChangeJournal::compact()
+    {
+        std::erase_if(entries, [](const Entry& entry) { return entry.id == STALE; });
+        for (std::size_t i = 0; i < entries.size(); ++i)
+            latest[key(entries[i].id, entries[i].component)] = i;
+        stale = 0;
+    }
+}
@@ -1,24 +1,80 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 #include <../include/ncs/base/utils.hpp>
 #include <../include/ncs/world.hpp>
 
 namespace ncs
 {
-    constexpr std::uint64_t ENTITY_MASK = 0x0000FFFFFFFFFFFF; /* 48 lower bits for entity id */
-	constexpr std::uint64_t GENERATION_SHIFT = 48; /* we need to shift 16 bits upper to accommodate the entity bits */
 	constexpr Generation MAX_GENERATION = 0xFFFF; /* for 16-bit generation */
 
+	/*
+	 * diff stream records. a stream opens with the tick it was closed at and a component table: a count,
+	 * then per component its id, key length, key bytes and size, so records can carry the sender's ids
+	 * and the receiver maps them onto its own. `SPAWN` selects the entity the following `SET` and
+	 * `REMOVE` records apply to. integers are LEB128 varints, component bytes are copied verbatim
+	 */
+	enum class DiffOp : std::uint8_t
+	{
+		SPAWN = 1, /* entity handle */
+		DESPAWN,   /* entity id */
+		SET,       /* component id, byte count, bytes */
+		REMOVE     /* component id */
+	};
+
+	static void put_varint(std::vector<std::byte> &out, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.emplace_back(static_cast<std::byte>(value | 0x80));
+			value >>= 7;
+		}
+		out.emplace_back(static_cast<std::byte>(value));
+	}
+
+	/* copy-constructs `value` over `row` of `column`, ending whatever lived there */
+	static void write_row(Column &column, const size_t row, const void *value)
+	{
+		column.destroy_at(row);
+		if (const CopierFn copier = column.get_copier())
+			copier(column.get(row), value);
+		else
+			std::memcpy(column.get(row), value, column.size());
+		column.mark_constructed(row);
+	}
+
+	static std::uint64_t get_varint(const std::span<const std::byte> in, std::size_t &at)
+	{
+		std::uint64_t value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			if (at >= in.size())
+				break;
+			const auto byte = static_cast<std::uint8_t>(in[at++]);
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		throw std::runtime_error("truncated diff stream");
+	}
+
     World::World() : root_archetype(create_archetype({})), alive_count(0), next_eid(0), next_cid(0) {}
 
 	World::~World()
 	{
-		for (auto& [hash, cache_entry] : qcaches)
+		invalidate_queries();
+
+		for (auto &[ptr, del]: resources)
 		{
-			auto& [ptr, del] = cache_entry;
-			del(ptr);
+			if (ptr)
+				del(ptr);
 		}
-		qcaches.clear();
+		resources.clear();
 
 		for (auto& [hash, archetype] : archetypes)
 		{
@@ -34,6 +90,8 @@ namespace ncs
 
     Entity World::entity()
     {
+		flush_reserved();
+
         Entity entity;
 		Generation gen;
 
@@ -41,18 +99,13 @@ namespace ncs
 		{
 			/* recycling */
 			entity = entity_pool[alive_count]; /* get the entity id to recycle */
-
-			const auto it = generations.find(entity);
-			gen = (it != generations.end() ? it->second : 0) + 1;
-
-			/* wrap around if generation is overflow */
-			gen = gen > MAX_GENERATION /* 16-bit */ ? 0 : gen;
+			gen = recycled_generation(entity);
 		}
 		else
 		{
 			/* newborn path */
-			entity = next_eid;
-			++next_eid;
+			entity = next_eid.fetch_add(1, std::memory_order_relaxed);
+			committed_eid = entity + 1;
 			gen = 0;
 
 			/* add to the pool */
@@ -60,23 +113,107 @@ namespace ncs
 		}
 
 		++alive_count;
-		generations[entity] = gen;
+		mark_alive(entity, gen);
 		entity_indices[entity] = alive_count - 1; /* store entity's position in the pool */
+		free_cursor.store(static_cast<std::int64_t>(entity_pool.size() - alive_count), std::memory_order_relaxed);
 		return encode_entity(entity, gen);
     }
 
+	std::vector<Entity> World::reserve_entities(const std::size_t n)
+	{
+		std::vector<Entity> reserved;
+		reserved.reserve(n);
+
+		/* claim dead slots from the back of the pool first, then mint fresh ids */
+		const auto count = static_cast<std::int64_t>(n);
+		const std::int64_t available = free_cursor.fetch_sub(count, std::memory_order_relaxed);
+		const std::int64_t recycled = std::clamp<std::int64_t>(available, 0, count);
+		for (std::int64_t i = 0; i < recycled; ++i)
+		{
+			const Entity id = entity_pool[alive_count + static_cast<std::size_t>(available - 1 - i)];
+			reserved.emplace_back(encode_entity(id, recycled_generation(id)));
+		}
+
+		const std::uint64_t fresh = n - static_cast<std::size_t>(recycled);
+		const std::uint64_t first = fresh > 0 ? next_eid.fetch_add(fresh, std::memory_order_relaxed) : 0;
+		for (std::uint64_t i = 0; i < fresh; ++i)
+			reserved.emplace_back(encode_entity(first + i, 0));
+
+		return reserved;
+	}
+
+	void World::flush_reserved()
+	{
+		const std::size_t dead = entity_pool.size() - alive_count;
+		const std::int64_t cursor = free_cursor.load(std::memory_order_relaxed);
+		const std::uint64_t issued = next_eid.load(std::memory_order_relaxed);
+		if (cursor == static_cast<std::int64_t>(dead) && issued == committed_eid)
+			return;
+
+		/* swaps a dead pool slot to the front of the dead range and marks its id alive */
+		const auto activate = [this](const std::size_t slot, const Generation gen)
+		{
+			const Entity id = entity_pool[slot];
+			std::swap(entity_pool[slot], entity_pool[alive_count]);
+			mark_alive(id, gen);
+			entity_indices[id] = alive_count;
+			++alive_count;
+		};
+
+		/* reserved recycled ids are the tail of the dead range */
+		const std::size_t kept = static_cast<std::size_t>(std::max<std::int64_t>(cursor, 0));
+		for (std::size_t slot = alive_count + kept; slot < entity_pool.size(); ++slot)
+			activate(slot, recycled_generation(entity_pool[slot]));
+
+		for (std::uint64_t id = committed_eid; id < issued; ++id)
+		{
+			entity_pool.emplace_back(id);
+			activate(entity_pool.size() - 1, 0);
+		}
+
+		committed_eid = issued;
+		free_cursor.store(static_cast<std::int64_t>(entity_pool.size() - alive_count), std::memory_order_relaxed);
+	}
+
+	Generation World::recycled_generation(const std::uint64_t id) const
+	{
+		/* `despawn()` already advanced the generation; the slot only lacks the alive bit */
+		return id < generations.size() ? generation_of(id) : 0;
+	}
+
+	void World::mark_alive(const std::uint64_t id, const Generation gen)
+	{
+		if (id >= generations.size())
+			generations.resize(std::max<std::size_t>(id + 1, generations.size() * 2), 0);
+		generations[id] = gen | ALIVE;
+		if (tracking)
+			journal.record(change_tick, id, ChangeJournal::LIFETIME);
+	}
+
     void World::despawn(const Entity entity)
 	{
+	    flush_reserved();
+
 	    const uint64_t entity_id = get_eid(entity);
-#ifndef NDEBUG
 	    /* check if the entity exists with valid generation */
-    	const Generation gen = get_egen(entity);
-	    if (const auto it = generations.find(entity_id);
-	        it == generations.end() || it->second != gen)
+	    if (!is_alive(entity))
+	        throw InvalidEntityError(entity_id, get_egen(entity), __FILE__, __LINE__);
+
+	    /* leave the hierarchy; children are orphaned and become roots */
+	    if (parent_of.contains(entity_id))
+		    unlink(entity_id);
+	    if (const auto children_it = children_of.find(entity_id);
+		    children_it != children_of.end())
 	    {
-	        throw InvalidEntityError(entity_id, gen, __FILE__, __LINE__);
+		    const std::vector<std::uint64_t> orphans = std::move(children_it->second);
+		    children_of.erase(children_it);
+		    for (const std::uint64_t child: orphans)
+		    {
+			    parent_of.erase(child);
+			    remove<Pair<ChildOf> >(encode_entity(child, generation_of(child)));
+		    }
+		    ++hierarchy_version;
 	    }
-	#endif
 
 	    /* remove all components */
 	    if (const auto record_it = entity_records.find(entity_id);
@@ -89,8 +226,10 @@ namespace ncs
 	        /* first call destructors for non-trivial components */
 	        for (Component comp_id: archetype->components)
 	        {
-	            if (Column &column = archetype->columns[comp_id];
-	                column.has_dtor() && column.is_constructed(row))
+	            Column &column = archetype->columns[comp_id];
+	            if (column.is_constructed(row))
+		            notify(&Observers::on_remove, comp_id, { &entity, 1 }, column.get(row));
+	            if (column.has_dtor() && column.is_constructed(row))
 	            {
 	                column.destroy_at(row);
 	            }
@@ -98,6 +237,7 @@ namespace ncs
 
 	        archetype->remove(entity_id);
 	        entity_records.erase(entity_id); /* clear the record */
+	        patch_swapped(archetype, row);
 	    }
 
 	    const auto idx_it = entity_indices.find(entity_id);
@@ -114,51 +254,1168 @@ namespace ncs
 	    entity_pool[alive_count - 1] = entity_id;
 	    --alive_count;
 
-	    /* update generation for reuse */
-	    generations[entity_id] = (generations[entity_id] + 1) > MAX_GENERATION ? 0 : generations[entity_id] + 1;
+	    /* update generation for reuse; clearing the alive bit invalidates every outstanding handle */
+	    const Generation gen = generation_of(entity_id);
+	    generations[entity_id] = gen == MAX_GENERATION ? 0 : gen + 1;
+	    if (tracking)
+		    journal.record(change_tick, entity_id, ChangeJournal::LIFETIME);
 	    entity_indices.erase(entity_id); /* clean up entity index */
+	    free_cursor.store(static_cast<std::int64_t>(entity_pool.size() - alive_count), std::memory_order_relaxed);
+
+		if (compaction.automatic && ++despawns_since_compact >= compaction.interval)
+			compact();
 	}
 
-	Entity World::encode_entity(const uint64_t id, const Generation gen)
-    {
-    	return (static_cast<Entity>(gen) << GENERATION_SHIFT) | (id & ENTITY_MASK);
-    }
+	std::vector<Entity> World::instantiate(const Entity prefab, const std::size_t n)
+	{
+		const uint64_t prefab_id = get_eid(prefab);
+		if (!is_alive(prefab))
+			throw InvalidEntityError(prefab_id, get_egen(prefab), __FILE__, __LINE__);
 
-	uint64_t World::get_eid(const Entity entity)
-    {
-    	return entity & ENTITY_MASK;
-    }
+		std::vector<Entity> instances;
+		instances.reserve(n);
+		for (std::size_t i = 0; i < n; ++i)
+			instances.emplace_back(entity());
 
-	Generation World::get_egen(const Entity entity)
-    {
-    	return static_cast<Generation>(entity >> GENERATION_SHIFT);
-    }
+		const auto record_it = entity_records.find(prefab_id);
+		if (record_it == entity_records.end() || n == 0)
+			return instances; /* nothing to copy */
+
+		Archetype *archetype = record_it->second.archetype;
+		const size_t prototype = record_it->second.row;
+		const size_t first = archetype->entity_count;
+
+		archetype->reserve(first + n);
+		for (const Entity instance: instances)
+		{
+			const uint64_t instance_id = get_eid(instance);
+			entity_records[instance_id] = { archetype, archetype->append(instance_id) };
+		}
+
+		for (auto &[comp_id, column]: archetype->columns)
+		{
+			column.fill(prototype, first, n);
+			notify(&Observers::on_add, comp_id, instances, column.get(first));
+			notify(&Observers::on_set, comp_id, instances, column.get(first));
+		}
+
+		/* copies inherit the prototype's place in the hierarchy */
+		if (const auto parent_it = parent_of.find(prefab_id);
+			parent_it != parent_of.end())
+		{
+			for (const Entity instance: instances)
+				link(get_eid(instance), parent_it->second);
+		}
+
+		return instances;
+	}
+
+	Component World::register_component(const ComponentDesc &desc)
+	{
+		if (desc.alignment > Column::ALIGNMENT)
+			throw std::invalid_argument("component alignment exceeds the column alignment");
+		if (!std::has_single_bit(desc.alignment))
+			throw std::invalid_argument("component alignment is not a power of two");
+		/* rows are packed at `size`, so only a multiple of the alignment keeps every row aligned */
+		if (desc.size % desc.alignment != 0)
+			throw std::invalid_argument("component size is not a multiple of its alignment");
+
+		std::string name(desc.name);
+		const std::size_t size = std::max<std::size_t>(desc.size, 1); /* tags take a byte, like empty types */
+		if (const auto it = component_names.find(name);
+			it != component_names.end())
+		{
+			/* the same name must mean the same layout, or rows would be read with the wrong shape */
+			const Component id = it->second;
+			const auto dtor = cdtors.find(id);
+			const auto copier = ccopiers.find(id);
+			if (component_sizes[id] != size || component_alignments[id] != desc.alignment
+				|| (dtor != cdtors.end() ? dtor->second : nullptr) != desc.destroy
+				|| (copier != ccopiers.end() ? copier->second : nullptr) != desc.copy)
+				throw std::invalid_argument("component name already registered with another layout");
+			return id;
+		}
+
+		NCS_COUNT(components_registered, 1);
+		const Component id = next_cid++;
+		component_keys.emplace_back("d" + name);
+		component_names.emplace(std::move(name), id);
+		component_sizes[id] = size;
+		component_alignments[id] = desc.alignment;
+		if (desc.destroy)
+			cdtors[id] = desc.destroy;
+		if (desc.copy)
+			ccopiers[id] = desc.copy;
+		return id;
+	}
+
+	World *World::set_raw(const Entity e, const Component c, const void *value)
+	{
+		const uint64_t entity_id = get_eid(e);
+		if (!is_alive(e))
+			throw InvalidEntityError(entity_id, get_egen(e), __FILE__, __LINE__);
+		if (c >= next_cid)
+			throw std::out_of_range("component was never registered");
+
+		/* a `ChildOf` pair is checked before anything is written, and linked once it is */
+		const bool childof = c == childof_cid();
+		const Entity parent = childof ? static_cast<const Pair<ChildOf> *>(value)->target : NULL_ENTITY;
+		if (childof)
+			check_parent(e, parent);
+
+		if (const auto record_it = entity_records.find(entity_id);
+			record_it == entity_records.end())
+		{
+			Archetype *dst = find_archetype_with(root_archetype, c);
+			const size_t row = dst->append(entity_id);
+			Column &column = dst->columns[c];
+			write_row(column, row, value);
+
+			entity_records[entity_id] = { dst, row };
+
+			notify(&Observers::on_add, c, { &e, 1 }, column.get(row));
+			notify(&Observers::on_set, c, { &e, 1 }, column.get(row));
+		}
+		else if (Record &record = record_it->second;
+			record.archetype->has(c))
+		{
+			Column &column = record.archetype->columns[c];
+			write_row(column, record.row, value);
+			++record.archetype->value_version;
+			notify(&Observers::on_set, c, { &e, 1 }, column.get(record.row));
+		}
+		else
+		{
+			Archetype *destination = find_archetype_with(record.archetype, c);
+			move_entity(entity_id, record, destination);
+
+			Column &column = destination->columns[c];
+			write_row(column, record.row, value);
+			notify(&Observers::on_add, c, { &e, 1 }, column.get(record.row));
+			notify(&Observers::on_set, c, { &e, 1 }, column.get(record.row));
+		}
+
+		if (childof)
+			link(entity_id, get_eid(parent));
+		return this;
+	}
+
+	void *World::get_raw(const Entity e, const Component c)
+	{
+		const uint64_t entity_id = get_eid(e);
+		if (!is_alive(e))
+			throw InvalidEntityError(entity_id, get_egen(e), __FILE__, __LINE__);
+
+		const auto it = entity_records.find(entity_id);
+		if (it == entity_records.end() || !it->second.archetype->has(c))
+			return nullptr;
+
+		const Column &column = it->second.archetype->columns[c];
+		return column.is_constructed(it->second.row) ? column.get(it->second.row) : nullptr;
+	}
+
+	World *World::remove_raw(const Entity e, const Component c)
+	{
+		const uint64_t entity_id = get_eid(e);
+
+		/* if it is valid; */
+		if (!is_alive(e))
+			throw InvalidEntityError(entity_id, get_egen(e), __FILE__, __LINE__);
+
+		const auto it = entity_records.find(entity_id);
+		if (it == entity_records.end())
+			return this;
+
+		Record &record = it->second;
+		Archetype *current = record.archetype;
+		if (!current->has(c))
+			return this;
+		if (c == childof_cid())
+			unlink(entity_id);
+
+		/* destroy the component if it's constructed */
+		Column &column = current->columns[c];
+		if (column.is_constructed(record.row))
+		{
+			notify(&Observers::on_remove, c, { &e, 1 }, column.get(record.row));
+			column.destroy_at(record.row);
+		}
+
+		Archetype *dst = find_archetype_without(current, c);
+		move_entity(entity_id, record, dst);
+		return this;
+	}
+
+	void World::apply(Commands &commands)
+	{
+		apply(std::span<Commands>(&commands, 1));
+	}
+
+	void World::apply(const std::span<Commands> buffers)
+	{
+		flush_reserved();
+
+		/* where each entity ends up; a later command on the same component overrides an earlier one */
+		struct Plan
+		{
+			Entity entity = NULL_ENTITY;
+			bool despawn = false;
+			std::vector<std::pair<Component, const void *> > writes = {};
+			std::vector<Component> removals = {};
+			Archetype *source = nullptr;
+			Archetype *target = nullptr;
+		};
+
+		std::vector<Plan> plans;
+		std::unordered_map<Entity, std::size_t> plan_of;
+		for (Commands &buffer: buffers)
+		{
+			for (const Commands::Command &command: buffer.commands)
+			{
+				const auto [it, inserted] = plan_of.try_emplace(command.entity, plans.size());
+				if (inserted)
+					plans.push_back(Plan { .entity = command.entity });
+
+				Plan &plan = plans[it->second];
+				if (plan.despawn)
+					continue; /* the handle is dead from here on */
+				if (command.op == Commands::Op::DESPAWN)
+				{
+					plan.despawn = true;
+					continue;
+				}
+
+				const Component c = command.resolve(*this);
+				std::erase_if(plan.writes, [c](const auto &write) { return write.first == c; });
+				std::erase(plan.removals, c);
+				if (command.op == Commands::Op::SET)
+					plan.writes.emplace_back(c, command.values->at(command.index));
+				else
+					plan.removals.emplace_back(c);
+			}
+		}
+
+		for (const Plan &plan: plans)
+		{
+			if (plan.despawn && is_alive(plan.entity))
+				despawn(plan.entity);
+		}
+
+		/* the hierarchy is kept beside the components */
+		const Component childof = childof_cid();
+
+		/*
+		 * `ChildOf` writes are checked in recording order against the hierarchy as this batch leaves it:
+		 * `planned` overlays `parent_of` with the links already accepted, `NO_PARENT` for removed ones
+		 */
+		constexpr std::uint64_t NO_PARENT = ~std::uint64_t { 0 };
+		std::unordered_map<std::uint64_t, std::uint64_t> planned;
+		const auto closes_cycle = [&](const std::uint64_t child, std::uint64_t id)
+		{
+			for (;;)
+			{
+				if (id == child)
+					return true;
+				if (const auto it = planned.find(id); it != planned.end())
+					id = it->second;
+				else if (const auto live = parent_of.find(id); live != parent_of.end())
+					id = live->second;
+				else
+					return false;
+				if (id == NO_PARENT)
+					return false;
+			}
+		};
+
+		/* resolve every destination up front so moves can be grouped by source and destination */
+		std::vector<Plan *> moving;
+		std::vector<Component> signature;
+		for (Plan &plan: plans)
+		{
+			if (plan.despawn || !is_alive(plan.entity))
+				continue;
+
+			const std::uint64_t id = get_eid(plan.entity);
+			std::erase_if(plan.writes, [&](const auto &write)
+			{
+				if (write.first != childof)
+					return false;
+
+				const Entity parent = static_cast<const Pair<ChildOf> *>(write.second)->target;
+				if (!is_alive(parent) || closes_cycle(id, get_eid(parent)))
+					return true;
+				planned[id] = get_eid(parent);
+				return false;
+			});
+			if (std::ranges::find(plan.removals, childof) != plan.removals.end())
+				planned[id] = NO_PARENT;
+
+			const auto record_it = entity_records.find(get_eid(plan.entity));
+			plan.source = record_it != entity_records.end() ? record_it->second.archetype : nullptr;
+			if (!plan.source && plan.writes.empty())
+				continue;
+
+			signature = plan.source ? plan.source->components : std::vector<Component> {};
+			for (const Component c: plan.removals)
+				std::erase(signature, c);
+			for (const auto &[c, value]: plan.writes)
+			{
+				if (std::ranges::find(signature, c) == signature.end())
+					signature.emplace_back(c);
+			}
+			plan.target = create_archetype(signature);
+			moving.emplace_back(&plan);
+		}
+
+		std::ranges::stable_sort(moving, [](const Plan *a, const Plan *b)
+		{
+			constexpr std::less<const Archetype *> less;
+			return a->source != b->source ? less(a->source, b->source) : less(a->target, b->target);
+		});
+
+		for (const Plan *plan: moving)
+		{
+			const Entity e = plan->entity;
+			const std::uint64_t id = get_eid(e);
+
+			if (plan->source)
+			{
+				Record &record = entity_records[id];
+				for (const Component c: plan->removals)
+				{
+					if (!plan->source->has(c))
+						continue;
+					if (c == childof)
+						unlink(id);
+
+					Column &column = plan->source->columns[c];
+					if (column.is_constructed(record.row))
+					{
+						notify(&Observers::on_remove, c, { &e, 1 }, column.get(record.row));
+						column.destroy_at(record.row);
+					}
+				}
+				move_entity(id, record, plan->target);
+			}
+			else
+			{
+				entity_records[id] = { plan->target, plan->target->append(id) };
+			}
+
+			const size_t row = entity_records[id].row;
+			for (const auto &[c, value]: plan->writes)
+			{
+				Column &column = plan->target->columns[c];
+				write_row(column, row, value);
+
+				if (plan->source && plan->source->has(c))
+					++plan->target->value_version;
+				else
+					notify(&Observers::on_add, c, { &e, 1 }, column.get(row));
+				notify(&Observers::on_set, c, { &e, 1 }, column.get(row));
+
+				/* relinked below, once every old link this batch replaces is gone */
+				if (c == childof)
+					unlink(id);
+			}
+		}
+
+		/* in recording order, the order the links were checked in, so none of them is refused */
+		for (const Plan &plan: plans)
+		{
+			if (!plan.target)
+				continue;
+			for (const auto &[c, value]: plan.writes)
+			{
+				if (c == childof)
+					link(get_eid(plan.entity), get_eid(static_cast<const Pair<ChildOf> *>(value)->target));
+			}
+		}
+
+		for (Commands &buffer: buffers)
+			buffer.clear();
+	}
+
+	std::vector<RawChunk> World::query(const std::span<const Component> components, const bool include_cold)
+	{
+		std::vector<RawChunk> result;
+		for (const auto &[hash, arch]: archetypes)
+		{
+			if (arch->entity_count == 0 || (arch->cold && !include_cold) ||
+			    !std::ranges::all_of(components, [arch](const Component c) { return arch->has(c); }))
+				continue;
+
+			RawChunk &chunk = result.emplace_back();
+			chunk.count = arch->entity_count;
+			chunk.entities = std::span<const Entity>(arch->entities.data(), arch->entity_count);
+			chunk.columns.reserve(components.size());
+			for (const Component c: components)
+				chunk.columns.emplace_back(arch->columns.at(c).data());
+		}
+
+		return result;
+	}
+
+	void World::merge(World &&other)
+	{
+		other.flush_reserved();
+
+		/* line up component ids; types and names this world has never seen are registered on the fly */
+		std::unordered_map<Component, Component> cids;
+		const auto line_up = [&](auto &registered, const auto &key, const Component foreign)
+		{
+			if (const auto it = registered.find(key);
+				it != registered.end())
+			{
+				cids[foreign] = it->second;
+				return;
+			}
+
+			const Component id = next_cid++;
+			registered.emplace(key, id);
+			component_keys.emplace_back(other.component_keys[foreign]);
+			component_sizes[id] = other.component_sizes[foreign];
+			if (const auto it = other.component_alignments.find(foreign); it != other.component_alignments.end())
+				component_alignments[id] = it->second;
+			if (const auto it = other.cdtors.find(foreign); it != other.cdtors.end())
+				cdtors[id] = it->second;
+			if (const auto it = other.ccopiers.find(foreign); it != other.ccopiers.end())
+				ccopiers[id] = it->second;
+			if (other.relation_cids.contains(foreign))
+				relation_cids.insert(id);
+			cids[foreign] = id;
+		};
+		for (const auto &[type, foreign]: other.component_types)
+			line_up(component_types, type, foreign);
+		for (const auto &[name, foreign]: other.component_names)
+			line_up(component_names, name, foreign);
+
+		/* remap every live entity of `other` in one pass */
+		std::unordered_map<std::uint64_t, Entity> ids;
+		ids.reserve(other.alive_count);
+		for (std::size_t i = 0; i < other.alive_count; ++i)
+			ids[other.entity_pool[i]] = entity();
+
+		const auto remap = [&ids](const Entity foreign)
+		{
+			const auto it = ids.find(get_eid(foreign));
+			return it != ids.end() ? it->second : NULL_ENTITY;
+		};
+
+		std::vector<Entity> handles;
+		for (auto it = other.archetypes.begin(); it != other.archetypes.end();)
+		{
+			Archetype *source = it->second;
+			const size_t count = source->entity_count;
+			if (count == 0)
+			{
+				++it;
+				continue;
+			}
+
+			std::vector<Component> signature;
+			signature.reserve(source->components.size());
+			for (const Component c: source->components)
+				signature.emplace_back(cids.at(c));
+			std::ranges::sort(signature);
+
+			handles.clear();
+			for (size_t row = 0; row < count; ++row)
+				handles.emplace_back(ids.at(source->entities[row]));
+
+			Archetype *target = find_archetype(signature);
+			size_t first = 0;
+			if (target)
+			{
+				/* splice: append the rows of every column in bulk */
+				first = target->entity_count;
+				target->reserve(first + count);
+				for (const Entity handle: handles)
+					target->append(get_eid(handle));
+
+				for (auto &[foreign, column]: source->columns)
+					target->columns[cids.at(foreign)].copy_rows(column, 0, first, count);
+				++it;
+			}
+			else
+			{
+				/* adopt: the archetype moves over as a whole, only ids need rewriting */
+				target = source;
+				it = other.archetypes.erase(it);
+
+				for (auto &[c, edge]: target->add_edge)
+					delete edge;
+				for (auto &[c, edge]: target->remove_edge)
+					delete edge;
+				target->add_edge.clear();
+				target->remove_edge.clear();
+
+				std::unordered_map<Component, Column> columns;
+				for (auto &[foreign, column]: target->columns)
+					columns[cids.at(foreign)] = std::move(column);
+				target->columns = std::move(columns);
+				target->components = signature;
+				target->id = archash(signature);
+				target->growth = growth;
+				archetypes[signature] = target;
+
+				target->entity_rows.clear();
+				for (size_t row = 0; row < count; ++row)
+				{
+					target->entities[row] = get_eid(handles[row]);
+					target->entity_rows[target->entities[row]] = row;
+				}
+				++target->structure_version;
+				++archetype_version;
+			}
+
+			for (size_t row = 0; row < count; ++row)
+				entity_records[get_eid(handles[row])] = { target, first + row };
+
+			for (auto &[cid, column]: target->columns)
+			{
+				/* relation targets point into `other` and follow the remapping */
+				if (relation_cids.contains(cid))
+				{
+					for (size_t row = first; row < first + count; ++row)
+					{
+						auto *target_entity = static_cast<Entity *>(column.get(row));
+						*target_entity = remap(*target_entity);
+					}
+				}
+
+				notify(&Observers::on_add, cid, handles, column.get(first));
+				notify(&Observers::on_set, cid, handles, column.get(first));
+			}
+		}
+
+		/* links to entities that did not come along are dropped, like any other dangling relation */
+		for (const auto &[child, parent]: other.parent_of)
+		{
+			const auto child_it = ids.find(child);
+			const auto parent_it = ids.find(parent);
+			if (child_it != ids.end() && parent_it != ids.end())
+				link(get_eid(child_it->second), get_eid(parent_it->second));
+		}
+
+		/* query caches only know the archetypes they were built against */
+		invalidate_queries();
+	}
+
+	std::vector<std::byte> World::diff_since(const std::uint64_t since)
+	{
+		flush_reserved();
+		tracking = true;
+
+		/* everything up to `since` is acknowledged; older ticks can no longer be served, but a snapshot can */
+		if (since != 0 && since < journal.floor())
+			throw std::invalid_argument("changes up to that tick were already acknowledged");
+		journal.trim(since);
+
+		std::vector<std::byte> out;
+		put_varint(out, change_tick);
+
+		/* the table covers every component a record could carry */
+		std::vector<Component> carried;
+		for (Component c = 0; c < next_cid; ++c)
+		{
+			if (!ccopiers.contains(c))
+				carried.emplace_back(c);
+		}
+		put_varint(out, carried.size());
+		for (const Component c: carried)
+		{
+			const std::string &key = component_keys[c];
+			put_varint(out, c);
+			put_varint(out, key.size());
+			const auto *bytes = reinterpret_cast<const std::byte *>(key.data());
+			out.insert(out.end(), bytes, bytes + key.size());
+			put_varint(out, component_sizes[c]);
+		}
+
+		const auto put_component = [&out](const Record &record, const Component c)
+		{
+			const Column &column = record.archetype->columns.at(c);
+			if (column.has_copier() || !column.is_constructed(record.row))
+				return;
+
+			const auto *bytes = static_cast<const std::byte *>(column.get(record.row));
+			out.emplace_back(static_cast<std::byte>(DiffOp::SET));
+			put_varint(out, c);
+			put_varint(out, column.size());
+			out.insert(out.end(), bytes, bytes + column.size());
+		};
+
+		const auto put_spawn = [this, &out](const std::uint64_t id)
+		{
+			out.emplace_back(static_cast<std::byte>(DiffOp::SPAWN));
+			put_varint(out, encode_entity(id, generation_of(id)));
+		};
+
+		if (since == 0)
+		{
+			for (std::size_t i = 0; i < alive_count; ++i)
+			{
+				put_spawn(entity_pool[i]);
+				if (const auto it = entity_records.find(entity_pool[i]);
+					it != entity_records.end())
+				{
+					for (const Component c: it->second.archetype->components)
+						put_component(it->second, c);
+				}
+			}
+
+			++change_tick;
+			return out;
+		}
+
+		/* group the journal by entity, keeping the order in which entities first show up */
+		std::vector<std::uint64_t> order;
+		std::unordered_map<std::uint64_t, std::vector<Component> > changed;
+		journal.visit_since(since, [&](const std::uint64_t id, const Component c)
+		{
+			auto [it, inserted] = changed.try_emplace(id);
+			if (inserted)
+				order.emplace_back(id);
+			if (c != ChangeJournal::LIFETIME)
+				it->second.emplace_back(c);
+		});
+
+		for (const std::uint64_t id: order)
+		{
+			if (id >= generations.size() || (generations[id] & ALIVE) == 0)
+			{
+				out.emplace_back(static_cast<std::byte>(DiffOp::DESPAWN));
+				put_varint(out, id);
+				continue;
+			}
+
+			/* the journal only says what changed; what goes out is the state as of now */
+			put_spawn(id);
+			const auto record_it = entity_records.find(id);
+			for (const Component c: changed[id])
+			{
+				if (ccopiers.contains(c))
+					continue;
+
+				if (record_it != entity_records.end() && record_it->second.archetype->has(c))
+				{
+					put_component(record_it->second, c);
+				}
+				else
+				{
+					out.emplace_back(static_cast<std::byte>(DiffOp::REMOVE));
+					put_varint(out, c);
+				}
+			}
+		}
+
+		++change_tick;
+		return out;
+	}
+
+	std::uint64_t World::apply_diff(const std::span<const std::byte> diff)
+	{
+		flush_reserved();
+
+		/* the hierarchy is kept beside the components */
+		const Component childof = childof_cid();
+
+		std::size_t at = 0;
+		const std::uint64_t closed = get_varint(diff, at);
+
+		/* the sender's ids onto ours, by key; unknown keys only fail once a record uses them */
+		constexpr Component UNKNOWN = ChangeJournal::LIFETIME;
+		std::unordered_map<std::string_view, Component> local;
+		for (Component c = 0; c < next_cid; ++c)
+			local.emplace(component_keys[c], c);
+
+		std::unordered_map<std::uint64_t, Component> cids;
+		const std::uint64_t table = get_varint(diff, at);
+		for (std::uint64_t i = 0; i < table; ++i)
+		{
+			const std::uint64_t foreign = get_varint(diff, at);
+			const std::uint64_t length = get_varint(diff, at);
+			if (length > diff.size() - at)
+				throw std::runtime_error("truncated diff stream");
+			const std::string_view key(reinterpret_cast<const char *>(diff.data() + at), length);
+			at += length;
+			const std::uint64_t size = get_varint(diff, at);
+
+			const auto it = local.find(key);
+			if (it != local.end() && (size != component_sizes[it->second] || ccopiers.contains(it->second)))
+				throw std::invalid_argument("component layout differs from the sending world");
+			cids[foreign] = it != local.end() ? it->second : UNKNOWN;
+		}
+
+		/* parents may arrive after their children; `ChildOf` pairs are set once the whole stream is in */
+		std::vector<std::pair<Entity, Pair<ChildOf> > > parents;
+
+		Entity current = NULL_ENTITY;
+		while (at < diff.size())
+		{
+			const auto op = static_cast<DiffOp>(diff[at++]);
+			if (op == DiffOp::SPAWN)
+			{
+				current = get_varint(diff, at);
+				adopt(current);
+				continue;
+			}
+
+			if (op == DiffOp::DESPAWN)
+			{
+				const std::uint64_t id = get_varint(diff, at);
+				if (id < generations.size() && (generations[id] & ALIVE) != 0)
+					despawn(encode_entity(id, generation_of(id)));
+				current = NULL_ENTITY;
+				continue;
+			}
+
+			if ((op != DiffOp::SET && op != DiffOp::REMOVE) || current == NULL_ENTITY)
+				throw std::runtime_error("malformed diff stream");
+
+			const auto cid_it = cids.find(get_varint(diff, at));
+			if (cid_it == cids.end())
+				throw std::runtime_error("malformed diff stream");
+			const Component c = cid_it->second;
+			if (c == UNKNOWN)
+				throw std::out_of_range("component was never registered");
+
+			if (op == DiffOp::REMOVE)
+			{
+				std::erase_if(parents, [current](const auto &parent) { return parent.first == current; });
+				remove_raw(current, c);
+				continue;
+			}
+
+			const std::uint64_t size = get_varint(diff, at);
+			if (size != component_sizes[c])
+				throw std::invalid_argument("component layout differs from the sending world");
+			if (size > diff.size() - at)
+				throw std::runtime_error("truncated diff stream");
+
+			if (c == childof)
+			{
+				Pair<ChildOf> pair;
+				std::memcpy(&pair, diff.data() + at, sizeof(pair));
+				parents.emplace_back(current, pair);
+			}
+			else
+			{
+				set_raw(current, c, diff.data() + at);
+			}
+			at += size;
+		}
+
+		/* a parent the stream left dead or that would close a cycle is dropped, as `apply()` does */
+		for (const auto &[child, pair]: parents)
+		{
+			if (!is_alive(child))
+				continue;
+			if (is_alive(pair.target) && !is_ancestor(get_eid(child), get_eid(pair.target)))
+				set_raw(child, childof, &pair);
+			else
+				remove_raw(child, childof);
+		}
+
+		return closed;
+	}
+
+	void World::track(const Component cid, const std::span<const Entity> entities)
+	{
+		for (const Entity e: entities)
+			journal.record(change_tick, get_eid(e), cid);
+	}
+
+	void World::adopt(const Entity e)
+	{
+		if (is_alive(e))
+			return;
+
+		const std::uint64_t id = get_eid(e);
+		if (id < generations.size() && (generations[id] & ALIVE) != 0)
+			despawn(encode_entity(id, generation_of(id))); /* an older generation the sender already replaced */
+
+		/* ids below `id` that this world never issued join the pool as dead slots */
+		for (std::uint64_t fresh = committed_eid; fresh <= id; ++fresh)
+			entity_pool.emplace_back(fresh);
+		if (id >= committed_eid)
+		{
+			committed_eid = id + 1;
+			next_eid.store(committed_eid, std::memory_order_relaxed);
+		}
+
+		/* the id sits in the dead range; freshly added ones at its very end */
+		const auto slot = std::find(entity_pool.rbegin(), entity_pool.rend() - static_cast<std::ptrdiff_t>(alive_count), id);
+		std::swap(*slot, entity_pool[alive_count]);
+		entity_indices[id] = alive_count;
+		++alive_count;
+		mark_alive(id, get_egen(e));
+		free_cursor.store(static_cast<std::int64_t>(entity_pool.size() - alive_count), std::memory_order_relaxed);
+	}
+
+	void World::despawn_recursive(const Entity entity)
+	{
+		/* collect the subtree breadth-first, then tear it down leaves first */
+		std::vector<std::uint64_t> subtree = { get_eid(entity) };
+		std::unordered_set<std::uint64_t> visited = { subtree.front() };
+		for (std::size_t i = 0; i < subtree.size(); ++i)
+		{
+			if (const auto it = children_of.find(subtree[i]);
+				it != children_of.end())
+			{
+				for (const std::uint64_t child: it->second)
+				{
+					if (visited.insert(child).second)
+						subtree.emplace_back(child);
+				}
+			}
+		}
+
+		for (std::size_t i = subtree.size(); i-- > 1;)
+			despawn(encode_entity(subtree[i], generation_of(subtree[i])));
+		despawn(entity);
+	}
+
+	bool World::link(const std::uint64_t child, const std::uint64_t parent)
+	{
+		if (is_ancestor(child, parent))
+			return false;
+
+		if (const auto it = parent_of.find(child);
+			it != parent_of.end())
+		{
+			if (it->second == parent)
+				return true;
+			unlink(child);
+		}
+
+		parent_of[child] = parent;
+		children_of[parent].emplace_back(child);
+		++hierarchy_version;
+		return true;
+	}
+
+	void World::check_parent(const Entity child, const Entity parent) const
+	{
+		if (!is_alive(parent))
+			throw InvalidEntityError(get_eid(parent), get_egen(parent), __FILE__, __LINE__);
+		if (is_ancestor(get_eid(child), get_eid(parent)))
+			throw std::invalid_argument("ChildOf pair would form a cycle");
+	}
+
+	Component World::childof_cid() const
+	{
+		const auto it = component_types.find(type_hash<Pair<ChildOf> >());
+		return it != component_types.end() ? it->second : ChangeJournal::LIFETIME;
+	}
+
+	bool World::is_ancestor(const std::uint64_t ancestor, std::uint64_t id) const
+	{
+		/* `link` never closes a cycle, so the walk always reaches a root */
+		while (id != ancestor)
+		{
+			const auto it = parent_of.find(id);
+			if (it == parent_of.end())
+				return false;
+			id = it->second;
+		}
+		return true;
+	}
+
+	void World::unlink(const std::uint64_t child)
+	{
+		const auto it = parent_of.find(child);
+		if (it == parent_of.end())
+			return;
+
+		if (const auto siblings_it = children_of.find(it->second);
+			siblings_it != children_of.end())
+		{
+			std::erase(siblings_it->second, child);
+			if (siblings_it->second.empty())
+				children_of.erase(siblings_it);
+		}
+
+		parent_of.erase(it);
+		++hierarchy_version;
+	}
+
+	void World::rebuild_hierarchy()
+	{
+		hierarchy_order.clear();
+		hierarchy_depths.clear();
+
+		/* roots are parents that are nobody's child */
+		for (const auto &[parent, children]: children_of)
+		{
+			if (!parent_of.contains(parent))
+				hierarchy_order.emplace_back(parent);
+		}
+		std::ranges::sort(hierarchy_order);
+
+		/* expand one depth at a time; ids caught in a cycle are never reached */
+		std::size_t begin = 0;
+		while (begin < hierarchy_order.size())
+		{
+			hierarchy_depths.emplace_back(begin);
+			const std::size_t end = hierarchy_order.size();
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				if (const auto it = children_of.find(hierarchy_order[i]);
+					it != children_of.end())
+					hierarchy_order.insert(hierarchy_order.end(), it->second.begin(), it->second.end());
+			}
+			begin = end;
+		}
+
+		hierarchy_built = hierarchy_version;
+	}
+
+	std::size_t World::compact()
+	{
+		despawns_since_compact = 0;
+
+		std::size_t reclaimed = 0;
+		std::unordered_set<Archetype *> released;
+		for (auto it = archetypes.begin(); it != archetypes.end();)
+		{
+			Archetype *archetype = it->second;
+			if (compaction.release_empty && archetype != root_archetype && archetype->entity_count == 0)
+			{
+				reclaimed += archetype->shrink(0) + sizeof(Archetype);
+				released.insert(archetype);
+				it = archetypes.erase(it);
+				continue;
+			}
+
+			reclaimed += archetype->shrink(compaction.min_rows);
+			++it;
+		}
+
+		/* drop the edges leading into released archetypes; the survivors relink lazily */
+		const auto prune = [&](std::unordered_map<Component, GraphEdge *> &edges)
+		{
+			for (auto it = edges.begin(); it != edges.end();)
+			{
+				if (released.contains(it->second->to))
+				{
+					reclaimed += sizeof(GraphEdge);
+					delete it->second;
+					it = edges.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		};
+
+		if (!released.empty())
+		{
+			for (auto &[hash, archetype]: archetypes)
+			{
+				prune(archetype->add_edge);
+				prune(archetype->remove_edge);
+			}
+		}
+
+		for (Archetype *archetype: released)
+		{
+			for (auto &[c, edge]: archetype->add_edge)
+				delete edge;
+			for (auto &[c, edge]: archetype->remove_edge)
+				delete edge;
+
+			reclaimed += (archetype->add_edge.size() + archetype->remove_edge.size()) * sizeof(GraphEdge);
+			delete archetype;
+		}
+
+		/* cached rows point into the buffers that were just reallocated or freed */
+		if (reclaimed > 0)
+			invalidate_queries();
+
+		return reclaimed;
+	}
+
+	void World::set_growth_policy(const GrowthPolicy &policy)
+	{
+		growth = policy;
+		for (auto &[signature, archetype]: archetypes)
+		{
+			archetype->growth = policy;
+			if (archetype->cold)
+				continue;
+			for (auto &[c, column]: archetype->columns)
+				column.set_backend(policy.backend, policy.mapped_reserve);
+		}
+	}
+
+	void World::set_cold(Archetype *archetype, const bool cold, const std::string &directory)
+	{
+		if (archetype->cold == cold)
+			return;
+
+		archetype->cold = cold;
+		for (auto &[c, column]: archetype->columns)
+		{
+			if (cold)
+				column.set_backend(ColumnBackend::FILE, 0, directory);
+			else
+				column.set_backend(archetype->growth.backend, archetype->growth.mapped_reserve);
+			column.migrate();
+			column.page_out();
+		}
+
+		/* every row moved, and queries visit a different set of archetypes now */
+		++archetype->structure_version;
+		++archetype_version;
+	}
+
+	void World::reserve_ids(const std::size_t n)
+	{
+		entity_pool.reserve(n);
+		entity_indices.reserve(n);
+		entity_records.reserve(n);
+		generations.reserve(n);
+	}
+
+	void World::set_compaction_policy(const CompactionPolicy &policy)
+	{
+		compaction = policy;
+		despawns_since_compact = 0;
+	}
+
+	Observers &World::observers_of(const Component cid)
+	{
+		if (cid >= observers.size())
+			observers.resize(cid + 1);
+		return observers[cid];
+	}
+
+	void World::unobserve(const ObserverHandle &handle)
+	{
+		if (!handle.list || handle.component >= observers.size())
+			return;
+
+		std::erase_if(observers[handle.component].*handle.list, [&handle](const Observer &observer)
+		{
+			return observer.id == handle.id;
+		});
+	}
+
+	void World::update_events()
+	{
+		for (auto &[id, update]: event_queues)
+		{
+			if (void *queue = id < resources.size() ? resources[id].first : nullptr)
+				update(queue);
+		}
+	}
+
+	std::size_t World::next_resource_id()
+	{
+		static std::atomic<std::size_t> next = 0;
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void World::invalidate_queries()
+	{
+		for (auto &[hash, cache_entry]: qcaches)
+			cache_entry.deleter(cache_entry.cache);
+		qcaches.clear();
+
+		for (auto &[hash, cache_entry]: hcaches)
+			cache_entry.deleter(cache_entry.cache);
+		hcaches.clear();
+	}
+
+	WorldStats World::stats() const
+	{
+		WorldStats out;
+		out.archetypes.reserve(archetypes.size());
+		out.queries.reserve(qcaches.size() + hcaches.size());
+
+		for (const auto &[hash, archetype]: archetypes)
+		{
+			ArchetypeStats &a = out.archetypes.emplace_back();
+			a.id = archetype->id;
+			a.components = archetype->components;
+			a.entity_count = archetype->entity_count;
+			a.capacity = archetype->entities.size();
+			a.cold = archetype->cold;
+			a.bytes_used = archetype->entity_count * sizeof(Entity);
+			a.bytes_reserved = archetype->entities.capacity() * sizeof(Entity);
+			for (const auto &[cid, column]: archetype->columns)
+			{
+				a.bytes_used += archetype->entity_count * column.size();
+				a.bytes_reserved += column.reserved_bytes();
+			}
+
+			out.map_overhead += map_footprint(archetype->entity_rows) + map_footprint(archetype->columns) +
+			                    map_footprint(archetype->add_edge) + map_footprint(archetype->remove_edge) +
+			                    (archetype->add_edge.size() + archetype->remove_edge.size()) * sizeof(GraphEdge);
+			out.bytes_used += a.bytes_used;
+			out.bytes_reserved += a.bytes_reserved;
+		}
+
+		for (const auto *caches: { &qcaches, &hcaches })
+		{
+			for (const auto &[hash, cache_entry]: *caches)
+			{
+				QueryCacheStats &q = out.queries.emplace_back();
+				q.hash = hash;
+				q.entries = cache_entry.entries(cache_entry.cache);
+				q.bytes = cache_entry.footprint(cache_entry.cache);
+				out.query_bytes += q.bytes;
+			}
+		}
+
+		out.entities.alive = alive_count;
+		out.entities.recyclable = entity_pool.size() - alive_count;
+		out.entities.capacity = entity_pool.capacity();
+		out.bytes_reserved += entity_pool.capacity() * sizeof(Entity);
+		out.bytes_reserved += generations.capacity() * sizeof(generations[0]);
+		out.map_overhead += resources.capacity() * sizeof(resources[0]);
+
+		out.map_overhead += map_footprint(archetypes) + map_footprint(entity_records) + map_footprint(cdtors) +
+		                    map_footprint(ccopiers) + map_footprint(qcaches) + map_footprint(hcaches) +
+		                    map_footprint(parent_of) + map_footprint(children_of) +
+		                    map_footprint(entity_indices) + map_footprint(component_types) + map_footprint(component_names) +
+		                    map_footprint(component_sizes);
+
+		out.total_bytes = out.bytes_reserved + out.query_bytes + out.map_overhead;
+		return out;
+	}
 
 	Archetype *World::create_archetype(const std::vector<Component> &components)
     {
     	std::vector<Component> sorted_components = components;
     	std::ranges::sort(sorted_components);
 
-    	const uint64_t hash = archash(sorted_components);
-    	if (const auto it = archetypes.find(hash);
+    	if (const auto it = archetypes.find(sorted_components);
 			it != archetypes.end())
     		return it->second;
 
+    	NCS_COUNT(archetypes_created, 1);
     	auto *archetype = new Archetype();
     	archetype->components = sorted_components;
-    	archetype->id = hash;
+    	archetype->id = archash(sorted_components);
+    	archetype->growth = growth;
 
     	for (Component comp_id: sorted_components)
     	{
     		Column column;
+    		column.set_backend(growth.backend, growth.mapped_reserve);
     		column.load_raw(component_sizes[comp_id],
 				   cdtors.contains(comp_id) ? cdtors[comp_id] : nullptr,
-				   nullptr);
-    		column.resize(16);
-    		archetype->columns[comp_id] = column;
+				   ccopiers.contains(comp_id) ? ccopiers[comp_id] : nullptr);
+    		column.resize(growth.initial_rows);
+    		archetype->columns[comp_id] = std::move(column);
     	}
 
-    	archetypes[hash] = archetype;
+    	archetypes.emplace(std::move(sorted_components), archetype);
+    	++archetype_version;
     	return archetype;
     }
 
@@ -192,8 +1449,7 @@ namespace ncs
 		std::vector<Component> sorted_components = components;
 		std::ranges::sort(sorted_components);
 
-		const uint64_t hash = archash(sorted_components);
-		if (const auto it = archetypes.find(hash);
+		if (const auto it = archetypes.find(sorted_components);
 			it != archetypes.end())
 			return it->second;
 
@@ -239,6 +1495,7 @@ namespace ncs
     	if (source == destination)
     		return;
 
+    	NCS_COUNT(entity_moves, 1);
     	const size_t src_row = record.row;
     	const size_t dest_row = destination->append(entity_id);
     	for (Component comp: source->components)
@@ -256,6 +1513,7 @@ namespace ncs
     				if (!src_ptr || !dst_ptr)
     					continue;
 
+    				NCS_COUNT(bytes_moved, src_col.size());
     				dst_col.destroy_at(dest_row);
     				if (src_col.has_copier()) /* non-trivial */
     				{
@@ -276,5 +1534,13 @@ namespace ncs
     	record.archetype = destination;
     	record.row = dest_row;
     	entity_records[entity_id] = record;
+    	patch_swapped(source, src_row);
     }
+
+	void World::patch_swapped(Archetype *archetype, const size_t row)
+	{
+		/* `Archetype::remove` fills the hole with its last entity; keep that entity's record in sync */
+		if (row < archetype->entity_count)
+			entity_records[archetype->entities[row]].row = row;
+	}
 }
@@ -1,3 +1,4 @@
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
@@ -289,3 +290,90 @@ TEST_F(ColumnTest, SwitchingTypes)
 	EXPECT_EQ(*int1, 42);
 	EXPECT_EQ(*int2, 43);
 }
+
+TEST_F(ColumnTest, MappedGrowsInPlace)
+{
+	TestClass::resetCounters();
+	column.set_backend(ncs::ColumnBackend::MAPPED, std::size_t { 64 } << 20);
+	column.load<TestClass>();
+	column.resize(16);
+
+	const void *base = column.data();
+	ASSERT_NE(base, nullptr);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(base) % ncs::Column::ALIGNMENT, 0);
+
+	for (int i = 0; i < 100000; ++i)
+	{
+		if (static_cast<std::size_t>(i) >= column.capacity())
+			column.resize(column.capacity() * 2);
+		column.construct_at<TestClass>(i, TestClass(i, "Item" + std::to_string(i)));
+	}
+
+	/* growth only committed more of the range: no row moved and nothing was copied */
+	EXPECT_EQ(column.data(), base);
+	EXPECT_EQ(TestClass::copy_count, 0);
+	EXPECT_EQ(column.get_as<TestClass>(99999)->name, "Item99999");
+
+	/* shrinking keeps the range and drops the tail pages */
+	const std::size_t before = column.reserved_bytes();
+	for (int i = 1000; i < 100000; ++i)
+		column.destroy_at(i);
+	EXPECT_GT(column.shrink(1000), 0);
+	EXPECT_LT(column.reserved_bytes(), before);
+	EXPECT_EQ(column.data(), base);
+	EXPECT_EQ(column.get_as<TestClass>(999)->value, 999);
+
+	/* outgrowing the reservation falls back to one copy into a bigger range */
+	ncs::Column small;
+	small.set_backend(ncs::ColumnBackend::MAPPED, 4096);
+	small.load<int>();
+	small.resize(16);
+	for (int i = 0; i < 16; ++i)
+		small.construct_at<int>(i, i);
+	small.resize(std::size_t { 4 } << 20);
+	EXPECT_EQ(*small.get_as<int>(15), 15);
+}
+
+TEST_F(ColumnTest, PermuteInPlace)
+{
+	TestClass::resetCounters();
+	column.set_backend(ncs::ColumnBackend::MAPPED, std::size_t { 1 } << 20);
+	column.load<TestClass>();
+	column.resize(8);
+	for (int i = 0; i < 6; ++i)
+		column.construct_at<TestClass>(i, TestClass(i, "Item" + std::to_string(i)));
+
+	/* two cycles and a fixed point; the reservation is kept rather than swapped for a new one */
+	const void *base = column.data();
+	const int live = TestClass::construct_count + TestClass::copy_count + TestClass::move_count
+					- TestClass::destruct_count;
+	column.permute({ 2, 0, 1, 3, 5, 4 });
+
+	EXPECT_EQ(column.data(), base);
+	const int expected[] = { 2, 0, 1, 3, 5, 4 };
+	for (int i = 0; i < 6; ++i)
+	{
+		ASSERT_TRUE(column.is_constructed(i));
+		EXPECT_EQ(column.get_as<TestClass>(i)->value, expected[i]);
+		EXPECT_EQ(column.get_as<TestClass>(i)->name, "Item" + std::to_string(expected[i]));
+	}
+	EXPECT_FALSE(column.is_constructed(6));
+	EXPECT_EQ(TestClass::construct_count + TestClass::copy_count + TestClass::move_count - TestClass::destruct_count,
+			live);
+
+	/* rows too wide for the stack scratch row */
+	using Wide = std::array<int, 128>;
+	ncs::Column wide;
+	wide.load<Wide>();
+	wide.resize(3);
+	for (int i = 0; i < 3; ++i)
+	{
+		Wide row {};
+		row.fill(i);
+		wide.construct_at<Wide>(i, row);
+	}
+	wide.permute({ 1, 2, 0 });
+	EXPECT_EQ(wide.get_as<Wide>(0)->back(), 1);
+	EXPECT_EQ(wide.get_as<Wide>(1)->back(), 2);
+	EXPECT_EQ(wide.get_as<Wide>(2)->back(), 0);
+}
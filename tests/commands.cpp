@@ -0,0 +1,154 @@
+#include <string>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Name
+{
+	std::string name;
+
+	Name() = default;
+
+	Name(std::string s) : name(std::move(s)) {}
+};
+
+class CommandsTest : public testing::Test
+{
+protected:
+	ncs::World world;
+};
+
+TEST_F(CommandsTest, DeferredUntilApplied)
+{
+	const auto existing = world.entity();
+	world.set<Position>(existing, Position { 1.0f, 0.0f, 0.0f });
+	const auto doomed = world.entity();
+	world.set<Position>(doomed, Position {});
+
+	ncs::Commands commands(world);
+	const auto spawned = commands.spawn();
+	commands.set<Position>(spawned, Position { 2.0f, 0.0f, 0.0f })
+	        ->set<Name>(spawned, Name { "spawned" });
+	commands.set<Velocity>(existing, Velocity { 3.0f, 0.0f, 0.0f });
+	commands.despawn(doomed);
+	commands.set<Velocity>(doomed, Velocity {}); /* dropped; the handle is dead by then */
+
+	EXPECT_EQ((world.query<Position>().size()), 2);
+	EXPECT_FALSE(world.has<Velocity>(existing));
+	EXPECT_EQ(commands.size(), 5);
+
+	world.apply(commands);
+	EXPECT_TRUE(commands.empty());
+
+	EXPECT_FALSE(world.is_alive(doomed));
+	EXPECT_EQ(world.get<Name>(spawned)->name, "spawned");
+	EXPECT_EQ(world.get<Position>(spawned)->x, 2.0f);
+	EXPECT_EQ(world.get<Velocity>(existing)->x, 3.0f);
+	EXPECT_EQ(world.get<Position>(existing)->x, 1.0f);
+}
+
+TEST_F(CommandsTest, OneMovePerEntity)
+{
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 4; ++i)
+		entities.emplace_back(world.entity());
+
+	std::size_t added = 0;
+	std::size_t removed = 0;
+	world.on_add<Velocity>([&added](ncs::Entity, Velocity *) { ++added; });
+	world.on_remove<Position>([&removed](ncs::Entity, Position *) { ++removed; });
+
+	ncs::Commands commands(world);
+	for (const auto e: entities)
+	{
+		commands.set<Position>(e, Position { 1.0f, 0.0f, 0.0f });
+		commands.set<Velocity>(e, Velocity { 0.0f, 1.0f, 0.0f });
+		commands.set<Position>(e, Position { 2.0f, 0.0f, 0.0f }); /* the last write wins */
+	}
+	world.apply(commands);
+
+	/* straight to {Position, Velocity}; no {Position} or {Velocity} archetype on the way */
+	EXPECT_EQ(world.stats().archetypes.size(), 2);
+	EXPECT_EQ(added, 4);
+	for (const auto e: entities)
+		EXPECT_EQ(*world.get<Position>(e), Position(2.0f, 0.0f, 0.0f));
+
+	/* a remove followed by a set of the same component keeps it */
+	commands.remove<Position>(entities[0]);
+	commands.set<Position>(entities[0], Position { 5.0f, 0.0f, 0.0f });
+	commands.remove<Position>(entities[1]);
+	world.apply(commands);
+
+	EXPECT_EQ(world.get<Position>(entities[0])->x, 5.0f);
+	EXPECT_FALSE(world.has<Position>(entities[1]));
+	EXPECT_TRUE(world.has<Velocity>(entities[1]));
+	EXPECT_EQ(removed, 1);
+}
+
+TEST_F(CommandsTest, Hierarchy)
+{
+	const auto parent = world.entity();
+	world.set<Position>(parent, Position {});
+
+	ncs::Commands commands(world);
+	const auto child = commands.spawn();
+	commands.set<Position>(child, Position {});
+	commands.set<ncs::Pair<ncs::ChildOf> >(child, { parent });
+	world.apply(commands);
+
+	const auto &hierarchy = world.query_hierarchy<Position>();
+	ASSERT_EQ(hierarchy.result.size(), 2);
+	EXPECT_EQ(hierarchy.depths.size(), 2);
+}
+
+TEST_F(CommandsTest, HierarchyRejectsCyclesAndDeadParents)
+{
+	const auto a = world.entity();
+	const auto b = world.entity();
+	const auto c = world.entity();
+	const auto dead = world.entity();
+	world.despawn(dead);
+
+	/* the first pair of the cycle is kept, the one closing it is dropped */
+	ncs::Commands commands(world);
+	commands.set<ncs::Pair<ncs::ChildOf> >(a, { b });
+	commands.set<ncs::Pair<ncs::ChildOf> >(b, { a });
+	commands.set<ncs::Pair<ncs::ChildOf> >(c, { dead });
+	world.apply(commands);
+
+	EXPECT_EQ(world.target<ncs::ChildOf>(a), b);
+	EXPECT_EQ(world.target<ncs::ChildOf>(b), ncs::NULL_ENTITY);
+	EXPECT_EQ(world.target<ncs::ChildOf>(c), ncs::NULL_ENTITY);
+
+	/* reversing the link inside one batch works as long as the old one goes first */
+	commands.remove<ncs::Pair<ncs::ChildOf> >(a);
+	commands.set<ncs::Pair<ncs::ChildOf> >(b, { a });
+	world.apply(commands);
+	EXPECT_EQ(world.target<ncs::ChildOf>(a), ncs::NULL_ENTITY);
+	EXPECT_EQ(world.target<ncs::ChildOf>(b), a);
+
+	world.despawn_recursive(a);
+	EXPECT_FALSE(world.is_alive(b));
+	EXPECT_TRUE(world.is_alive(c));
+}
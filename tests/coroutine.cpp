@@ -0,0 +1,130 @@
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+#include <addons/coroutine.hpp>
+#include <addons/scheduler.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class CoroutineTest : public testing::Test
+{
+protected:
+	ncs::World world;
+};
+
+TEST_F(CoroutineTest, NextFrame)
+{
+	std::vector<std::uint64_t> frames;
+	auto &tasks = ncs::executor(world);
+	tasks.spawn([](ncs::World &w, std::vector<std::uint64_t> &out) -> ncs::Task<>
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			out.emplace_back(ncs::executor(w).frame());
+			co_await ncs::next_frame(w);
+		}
+		co_await ncs::next_frame(w, 10); /* a timer, not a per-frame check */
+		out.emplace_back(ncs::executor(w).frame());
+	}(world, frames));
+
+	EXPECT_TRUE(frames.empty()); /* spawned tasks start on the next tick */
+	for (int i = 0; i < 20; ++i)
+		tasks.tick();
+
+	EXPECT_EQ(frames, (std::vector<std::uint64_t> { 1, 2, 3, 14 }));
+	EXPECT_EQ(tasks.pending(), 0);
+}
+
+TEST_F(CoroutineTest, WaitFor)
+{
+	const auto e = world.entity();
+	world.set<Position>(e, Position { 1.0f, 2.0f, 3.0f });
+
+	Velocity seen;
+	bool resumed = false;
+	ncs::executor(world).spawn([](ncs::World &w, const ncs::Entity target, Velocity &out, bool &done) -> ncs::Task<>
+	{
+		const Velocity *velocity = co_await ncs::wait_for<Velocity>(w, target);
+		out = *velocity;
+		done = true;
+	}(world, e, seen, resumed));
+
+	ncs::Scheduler scheduler(world, 1);
+	for (int i = 0; i < 5; ++i)
+		scheduler.run();
+	EXPECT_FALSE(resumed);
+
+	world.set<Velocity>(e, Velocity { 4.0f, 0.0f, 0.0f });
+	EXPECT_FALSE(resumed); /* woken by the observer, resumed by the next frame */
+	scheduler.run();
+	EXPECT_TRUE(resumed);
+	EXPECT_EQ(seen, Velocity(4.0f, 0.0f, 0.0f));
+}
+
+TEST_F(CoroutineTest, AwaitTasks)
+{
+	for (int i = 0; i < 10; ++i)
+		world.set<Position>(world.entity(), Position { static_cast<float>(i), 0.0f, 0.0f });
+
+	/* a query spread over two frames, awaited like any other task */
+	const auto sum = [](ncs::World &w) -> ncs::Task<float>
+	{
+		float total = 0.0f;
+		for (auto &[e, pos]: w.query<Position>())
+			total += pos->x;
+		co_await ncs::next_frame(w);
+		co_return total;
+	};
+
+	float result = 0.0f;
+	auto &tasks = ncs::executor(world);
+	tasks.spawn([](ncs::World &w, auto query, float &out) -> ncs::Task<>
+	{
+		out = co_await query(w);
+	}(world, sum, result));
+
+	tasks.tick();
+	EXPECT_EQ(result, 0.0f);
+	tasks.tick();
+	EXPECT_EQ(result, 45.0f);
+}
+
+TEST_F(CoroutineTest, ErrorsReachTheTick)
+{
+	auto &tasks = ncs::executor(world);
+	tasks.spawn([](ncs::World &w) -> ncs::Task<>
+	{
+		co_await ncs::next_frame(w);
+		throw std::runtime_error("task failed");
+	}(world));
+
+	/* an unfinished task is destroyed with the world */
+	tasks.spawn([](ncs::World &w) -> ncs::Task<>
+	{
+		co_await ncs::next_frame(w, 1000);
+	}(world));
+
+	tasks.tick();
+	EXPECT_THROW(tasks.tick(), std::runtime_error);
+	EXPECT_EQ(tasks.pending(), 1);
+}
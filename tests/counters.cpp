@@ -0,0 +1,129 @@
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class CountersTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if constexpr (!ncs::COUNTERS_ENABLED)
+			GTEST_SKIP() << "built without NCS_COUNTERS_ENABLE";
+		ncs::reset_counters();
+	}
+
+	ncs::World world;
+};
+
+TEST_F(CountersTest, StructuralOperations)
+{
+	const auto e = world.entity();
+	world.set<Position>(e, { 1.0f, 2.0f, 3.0f });
+	world.set<Velocity>(e, { 4.0f, 5.0f, 6.0f });
+
+	const ncs::Counters &c = ncs::counters();
+	EXPECT_EQ(c.components_registered, 2);
+	EXPECT_EQ(c.archetypes_created, 2); /* {P} and {P, V} */
+	EXPECT_EQ(c.entity_moves, 1);
+	EXPECT_EQ(c.bytes_moved, sizeof(Position));
+
+	world.query<Position, Velocity>();
+	world.query<Position, Velocity>();
+	EXPECT_EQ(c.query_rebuilds, 1);
+	EXPECT_EQ(c.query_hits, 1);
+
+	/* value writes never move rows, so the cache is served as is */
+	world.set<Position>(e, { 7.0f, 8.0f, 9.0f });
+	world.query<Position, Velocity>();
+	EXPECT_EQ(c.query_rebuilds, 1);
+	EXPECT_EQ(c.query_updates, 0);
+	EXPECT_EQ(c.query_hits, 2);
+}
+
+TEST_F(CountersTest, SortDisplacesOnlyChangedRows)
+{
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 256; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, { static_cast<float>(i), 0.0f, 0.0f });
+		entities.emplace_back(e);
+	}
+
+	const auto by_x = [](const Position &a, const Position &b) { return a.x < b.x; };
+	world.sort_by<Position>(by_x);
+	EXPECT_EQ(ncs::counters().rows_resorted, 0);
+
+	/* one raised key near the front, one lowered key near the back */
+	world.get<Position>(entities[3])->x = 1000.0f;
+	world.sort_by<Position>(by_x);
+	EXPECT_EQ(ncs::counters().rows_resorted, 1);
+
+	world.get<Position>(entities[250])->x = -1.0f;
+	world.sort_by<Position>(by_x);
+	EXPECT_EQ(ncs::counters().rows_resorted, 2);
+
+	EXPECT_EQ(std::get<ncs::Entity>(world.query<Position>().front()), entities[250]);
+	EXPECT_EQ(std::get<ncs::Entity>(world.query<Position>().back()), entities[3]);
+}
+
+TEST_F(CountersTest, HierarchyIgnoresUnrelatedArchetypes)
+{
+	const auto parent = world.entity();
+	world.set<Position>(parent, { 0.0f, 0.0f, 0.0f });
+	const auto child = world.entity();
+	world.set<Position>(child, { 1.0f, 0.0f, 0.0f });
+	world.pair<ncs::ChildOf>(child, parent);
+
+	world.query_hierarchy<Position>();
+	world.query_hierarchy<Position>();
+	EXPECT_EQ(ncs::counters().hierarchy_rebuilds, 1);
+
+	/* rows moving in archetypes without `Position` leave the hierarchy alone */
+	const auto other = world.entity();
+	world.set<Velocity>(other, { 1.0f, 0.0f, 0.0f });
+	world.remove<Velocity>(other);
+	world.query_hierarchy<Position>();
+	EXPECT_EQ(ncs::counters().hierarchy_rebuilds, 1);
+
+	/* a matching archetype that moved is resolved again */
+	world.set<Velocity>(child, { 1.0f, 0.0f, 0.0f });
+	EXPECT_EQ(world.query_hierarchy<Position>().result.size(), 2);
+	EXPECT_EQ(ncs::counters().hierarchy_rebuilds, 2);
+}
+
+TEST_F(CountersTest, PerThread)
+{
+	std::thread([]
+	{
+		ncs::World other;
+		const auto e = other.entity();
+		other.set<Position>(e, { 1.0f, 2.0f, 3.0f });
+		EXPECT_EQ(ncs::counters().archetypes_created, 2); /* root and {P} */
+	}).join();
+
+	EXPECT_EQ(ncs::counters().archetypes_created, 0);
+}
@@ -280,3 +280,71 @@ TEST_F(CRUDTest, NonTrivial)
 	// world.despawn(entity);
 	// world.despawn(entity2);
 }
+
+TEST_F(CRUDTest, Instantiate)
+{
+	world.set<Position>(entity, { 1.0f, 2.0f, 3.0f });
+	world.set<Health>(entity, { 100 });
+	world.set<Name>(entity, { "Enemy" });
+
+	const auto instances = world.instantiate(entity, 37);
+	ASSERT_EQ(instances.size(), 37);
+
+	for (const auto instance: instances)
+	{
+		EXPECT_NE(instance, entity);
+		ASSERT_TRUE(world.has<Position>(instance));
+		EXPECT_EQ(*world.get<Position>(instance), Position(1.0f, 2.0f, 3.0f));
+		EXPECT_EQ(world.get<Health>(instance)->value, 100);
+		EXPECT_EQ(world.get<Name>(instance)->name, "Enemy");
+		EXPECT_FALSE(world.has<Velocity>(instance));
+	}
+
+	/* copies are independent of the prototype */
+	world.get<Name>(instances[0])->name = "Boss";
+	world.set<Health>(instances[1], { 5 });
+	EXPECT_EQ(world.get<Name>(entity)->name, "Enemy");
+	EXPECT_EQ(world.get<Health>(entity)->value, 100);
+	EXPECT_EQ(world.get<Health>(instances[2])->value, 100);
+
+	EXPECT_EQ((world.query<Position, Health, Name>().size()), 38);
+
+	world.despawn(instances[0]);
+	EXPECT_EQ(world.get<Name>(instances[36])->name, "Enemy");
+}
+
+TEST_F(CRUDTest, GetMany)
+{
+	std::vector<ncs::Entity> targets;
+	for (auto i = 0; i < 40; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, { static_cast<float>(i), 0.0f, 0.0f });
+		if (i % 3 == 0)
+			world.set<Velocity>(e, {}); /* spread the handles over two archetypes */
+		targets.emplace_back(e);
+	}
+	const auto bare = world.entity();
+	const auto dead = world.entity();
+	world.despawn(dead);
+
+	/* interleaved and repeated, the way target references look */
+	std::vector<ncs::Entity> lookups;
+	for (auto i = 39; i >= 0; i -= 2)
+		lookups.emplace_back(targets[i]);
+	lookups.emplace_back(bare);
+	lookups.emplace_back(dead);
+	lookups.emplace_back(targets[4]);
+
+	std::vector<Position *> out(lookups.size());
+	world.get_many<Position>(lookups, out);
+
+	for (std::size_t i = 0; i + 3 < lookups.size(); ++i)
+		EXPECT_EQ(out[i], world.get<Position>(lookups[i]));
+	EXPECT_EQ(out[lookups.size() - 3], nullptr);
+	EXPECT_EQ(out[lookups.size() - 2], nullptr);
+	EXPECT_EQ(out.back()->x, 4.0f);
+
+	std::vector<Position *> short_out(1);
+	EXPECT_THROW(world.get_many<Position>(lookups, short_out), std::invalid_argument);
+}
@@ -0,0 +1,196 @@
+#include <string>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Name
+{
+	std::string name;
+
+	Name() = default;
+
+	Name(std::string s) : name(std::move(s)) {}
+};
+
+class DiffTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		/* the ends need not register their components in the same order */
+		source.reserve<Position, Velocity>(0);
+		replica.reserve<Velocity, Position>(0);
+	}
+
+	ncs::World source;
+	ncs::World replica;
+};
+
+TEST_F(DiffTest, SnapshotThenDeltas)
+{
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 100; ++i)
+	{
+		const auto e = source.entity();
+		source.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		if (i % 2 == 0)
+			source.set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+		entities.emplace_back(e);
+	}
+
+	const auto snapshot = source.diff_since(0);
+	EXPECT_EQ(replica.apply_diff(snapshot), source.tick());
+	const auto acked = source.tick();
+
+	EXPECT_EQ((replica.query<Position>().size()), 100);
+	EXPECT_EQ((replica.query<Position, Velocity>().size()), 50);
+	for (const auto e: entities)
+	{
+		ASSERT_TRUE(replica.is_alive(e));
+		EXPECT_EQ(*replica.get<Position>(e), *source.get<Position>(e));
+	}
+
+	/* a handful of changes make a stream that is small next to the snapshot */
+	source.set<Position>(entities[3], Position { -3.0f, 0.0f, 0.0f });
+	source.remove<Velocity>(entities[4]);
+	source.despawn(entities[5]);
+	const auto spawned = source.entity();
+	source.set<Velocity>(spawned, Velocity { 0.0f, 2.0f, 0.0f });
+
+	const auto delta = source.diff_since(acked);
+	EXPECT_LT(delta.size() * 20, snapshot.size());
+	replica.apply_diff(delta);
+
+	EXPECT_EQ(replica.get<Position>(entities[3])->x, -3.0f);
+	EXPECT_FALSE(replica.has<Velocity>(entities[4]));
+	EXPECT_FALSE(replica.is_alive(entities[5]));
+	ASSERT_TRUE(replica.is_alive(spawned));
+	EXPECT_EQ(*replica.get<Velocity>(spawned), Velocity(0.0f, 2.0f, 0.0f));
+	EXPECT_EQ((replica.query<Position>().size()), 99);
+
+	/* nothing changed since the last diff: the stream is only its tick and component table */
+	const auto idle = source.diff_since(source.tick());
+	replica.apply_diff(idle);
+	EXPECT_LT(idle.size(), 64);
+
+	/* acknowledged changes are forgotten; a replica that far behind starts from a snapshot */
+	EXPECT_THROW(source.diff_since(acked), std::invalid_argument);
+	ncs::World late;
+	late.reserve<Position, Velocity>(0);
+	late.apply_diff(source.diff_since(0));
+	EXPECT_EQ((late.query<Position>().size()), 99);
+}
+
+TEST_F(DiffTest, RecycledIdsAndTouch)
+{
+	const auto first = source.entity();
+	source.set<Position>(first, Position { 1.0f, 0.0f, 0.0f });
+	replica.apply_diff(source.diff_since(0));
+
+	/* the id comes back with a new generation; the replica must drop the old one */
+	const auto acked = source.tick();
+	source.despawn(first);
+	const auto second = source.entity();
+	ASSERT_EQ(ncs::World::get_eid(first), ncs::World::get_eid(second));
+	source.set<Velocity>(second, Velocity { 5.0f, 0.0f, 0.0f });
+
+	/* raw writes are invisible until announced */
+	source.get<Velocity>(second)->y = 6.0f;
+	source.touch<Velocity>(second);
+
+	replica.apply_diff(source.diff_since(acked));
+	EXPECT_FALSE(replica.is_alive(first));
+	ASSERT_TRUE(replica.is_alive(second));
+	EXPECT_FALSE(replica.has<Position>(second));
+	EXPECT_EQ(*replica.get<Velocity>(second), Velocity(5.0f, 6.0f, 0.0f));
+}
+
+TEST_F(DiffTest, SkipsNonTrivialComponentsAndRejectsBadStreams)
+{
+	const auto e = source.entity();
+	source.set<Position>(e, Position { 1.0f, 2.0f, 3.0f });
+	source.set<Name>(e, Name { "local" });
+
+	replica.apply_diff(source.diff_since(0));
+	EXPECT_TRUE(replica.has<Position>(e));
+	EXPECT_FALSE(replica.has<Name>(e));
+
+	auto truncated = source.diff_since(0);
+	truncated.pop_back();
+	ncs::World other;
+	other.reserve<Position, Velocity>(0);
+	EXPECT_THROW(other.apply_diff(truncated), std::runtime_error);
+
+	/* a component the replica does not know, or knows with another size, is refused */
+	const auto blob = source.register_component({ .name = "blob", .size = 4, .alignment = 4 });
+	const std::uint32_t bits = 7;
+	source.set_raw(e, blob, &bits);
+	ncs::World unaware;
+	unaware.reserve<Position>(0);
+	EXPECT_THROW(unaware.apply_diff(source.diff_since(0)), std::out_of_range);
+	ncs::World wider;
+	wider.register_component({ .name = "blob", .size = 8, .alignment = 8 });
+	EXPECT_THROW(wider.apply_diff(source.diff_since(0)), std::invalid_argument);
+}
+
+TEST_F(DiffTest, Hierarchy)
+{
+	const auto parent = source.entity();
+	const auto child = source.entity();
+	source.set<Position>(parent, Position {});
+	source.set<Position>(child, Position {});
+
+	replica.reserve<ncs::Pair<ncs::ChildOf> >(0);
+	source.reserve<ncs::Pair<ncs::ChildOf> >(0);
+	replica.apply_diff(source.diff_since(0));
+
+	const auto acked = source.tick();
+	source.pair<ncs::ChildOf>(child, parent);
+	replica.apply_diff(source.diff_since(acked));
+
+	EXPECT_EQ(replica.target<ncs::ChildOf>(child), parent);
+	const auto &hierarchy = replica.query_hierarchy<Position>();
+	ASSERT_EQ(hierarchy.result.size(), 2);
+	ASSERT_EQ(hierarchy.depths.size(), 2);
+	EXPECT_EQ(std::get<0>(hierarchy.result[0]), parent);
+}
+
+TEST_F(DiffTest, ChildrenBeforeParents)
+{
+	/* the child's id comes first, so a snapshot carries its pair before the parent exists */
+	const auto child = source.entity();
+	const auto parent = source.entity();
+	source.set<Position>(child, Position { 1.0f, 0.0f, 0.0f });
+	source.set<Position>(parent, Position {});
+	source.pair<ncs::ChildOf>(child, parent);
+
+	replica.reserve<ncs::Pair<ncs::ChildOf> >(0);
+	replica.apply_diff(source.diff_since(0));
+
+	EXPECT_EQ(replica.target<ncs::ChildOf>(child), parent);
+	EXPECT_EQ(replica.get<Position>(child)->x, 1.0f);
+	const auto &hierarchy = replica.query_hierarchy<Position>();
+	ASSERT_EQ(hierarchy.result.size(), 2);
+	EXPECT_EQ(std::get<0>(hierarchy.result[0]), parent);
+}
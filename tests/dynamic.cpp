@@ -0,0 +1,145 @@
+#include <array>
+#include <cstring>
+#include <string>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class DynamicTest : public testing::Test
+{
+protected:
+	ncs::World world;
+
+	/* what a scripting layer would hand over for a type it defined itself */
+	ncs::Component register_script()
+	{
+		return world.register_component({
+			.name = "Script",
+			.size = sizeof(std::string),
+			.alignment = alignof(std::string),
+			.copy = [](void *dst, const void *src)
+			{
+				std::construct_at(static_cast<std::string *>(dst), *static_cast<const std::string *>(src));
+			},
+			.destroy = [](void *ptr) { std::destroy_at(static_cast<std::string *>(ptr)); }
+		});
+	}
+};
+
+TEST_F(DynamicTest, SetGetRemove)
+{
+	const auto script = register_script();
+	const auto speed = world.register_component({ .name = "Speed", .size = sizeof(float), .alignment = alignof(float) });
+	EXPECT_NE(script, speed);
+	EXPECT_EQ(register_script(), script);
+
+	const auto e = world.entity();
+	const std::string source = "on_tick() { return a very long script body that will not fit inline; }";
+	const float value = 4.5f;
+	world.set_raw(e, script, &source);
+	world.set_raw(e, speed, &value);
+	world.set<Position>(e, Position { 1.0f, 2.0f, 3.0f });
+
+	ASSERT_NE(world.get_raw(e, script), nullptr);
+	EXPECT_EQ(*static_cast<const std::string *>(world.get_raw(e, script)), source);
+	EXPECT_EQ(*static_cast<const float *>(world.get_raw(e, speed)), 4.5f);
+	EXPECT_EQ(*world.get<Position>(e), Position(1.0f, 2.0f, 3.0f));
+
+	const std::string replaced = "noop";
+	world.set_raw(e, script, &replaced);
+	EXPECT_EQ(*static_cast<const std::string *>(world.get_raw(e, script)), "noop");
+
+	world.remove_raw(e, speed);
+	EXPECT_EQ(world.get_raw(e, speed), nullptr);
+	EXPECT_EQ(*static_cast<const std::string *>(world.get_raw(e, script)), "noop");
+	world.despawn(e);
+}
+
+TEST_F(DynamicTest, RuntimeQuery)
+{
+	const auto script = register_script();
+	const auto speed = world.register_component({ .name = "Speed", .size = sizeof(float), .alignment = alignof(float) });
+
+	for (auto i = 0; i < 50; ++i)
+	{
+		const auto e = world.entity();
+		const float value = static_cast<float>(i);
+		world.set_raw(e, speed, &value);
+		world.set<Position>(e, Position { 0.0f, 0.0f, 0.0f });
+		if (i % 5 == 0)
+		{
+			const std::string name = "script_" + std::to_string(i);
+			world.set_raw(e, script, &name);
+		}
+	}
+
+	/* dynamic and templated components mix in one query */
+	const std::array<ncs::Component, 2> terms = { speed, world.register_component({ .name = "Unused", .size = 4, .alignment = 4 }) };
+	EXPECT_TRUE(world.query(std::span(terms)).empty());
+
+	const std::array<ncs::Component, 1> moving = { speed };
+	std::size_t rows = 0;
+	float sum = 0.0f;
+	for (const auto &chunk: world.query(std::span(moving)))
+	{
+		for (const float v: chunk.get<float>(0))
+			sum += v;
+		rows += chunk.count;
+	}
+	EXPECT_EQ(rows, 50);
+	EXPECT_EQ(sum, 50.0f * 49.0f / 2.0f);
+	EXPECT_EQ((world.query<Position>().size()), 50);
+
+	const std::array<ncs::Component, 2> scripted = { script, speed };
+	rows = 0;
+	for (const auto &chunk: world.query(std::span(scripted)))
+	{
+		const auto names = chunk.get<std::string>(0);
+		const auto speeds = chunk.get<float>(1);
+		for (std::size_t i = 0; i < chunk.count; ++i)
+			EXPECT_EQ(names[i], "script_" + std::to_string(static_cast<int>(speeds[i])));
+		rows += chunk.count;
+	}
+	EXPECT_EQ(rows, 10);
+}
+
+TEST_F(DynamicTest, RejectsMisalignedLayouts)
+{
+	EXPECT_THROW(world.register_component({ .name = "Packed", .size = 12, .alignment = 8 }), std::invalid_argument);
+	EXPECT_THROW(world.register_component({ .name = "Odd", .size = 12, .alignment = 3 }), std::invalid_argument);
+
+	const auto wide = world.register_component({ .name = "Wide", .size = 16, .alignment = 8 });
+	for (auto i = 0; i < 8; ++i)
+	{
+		const auto e = world.entity();
+		const std::array<std::uint64_t, 2> value = { 1, 2 };
+		world.set_raw(e, wide, value.data());
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(world.get_raw(e, wide)) % 8, 0);
+	}
+	EXPECT_EQ(world.register_component({ .name = "Wide", .size = 16, .alignment = 8 }), wide);
+}
+
+TEST_F(DynamicTest, RejectsConflictingLayouts)
+{
+	const auto copy = [](void *dst, const void *src) { std::memcpy(dst, src, 16); };
+	const auto destroy = [](void *) {};
+	const auto id = world.register_component({ .name = "Shape", .size = 16, .alignment = 8 });
+
+	EXPECT_THROW(world.register_component({ .name = "Shape", .size = 32, .alignment = 8 }), std::invalid_argument);
+	EXPECT_THROW(world.register_component({ .name = "Shape", .size = 16, .alignment = 16 }), std::invalid_argument);
+	EXPECT_THROW(world.register_component({ .name = "Shape", .size = 16, .alignment = 8, .copy = copy }),
+				std::invalid_argument);
+	EXPECT_THROW(world.register_component({ .name = "Shape", .size = 16, .alignment = 8, .destroy = destroy }),
+				std::invalid_argument);
+	EXPECT_EQ(world.register_component({ .name = "Shape", .size = 16, .alignment = 8 }), id);
+}
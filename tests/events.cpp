@@ -0,0 +1,99 @@
+#include <thread>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Damage
+{
+	ncs::Entity target;
+	int amount;
+};
+
+TEST(EventsTest, TwoFrameLifetime)
+{
+	ncs::World world;
+	auto &damage = world.events<Damage>();
+	EXPECT_EQ(&world.events<Damage>(), &damage);
+
+	ncs::EventCursor early, late;
+	damage.send({ 1, 10 });
+	damage.send({ 2, 20 });
+
+	/* nothing is visible before the frame boundary */
+	EXPECT_EQ(damage.read(early, [](const Damage &) {}), 0);
+	world.update_events();
+
+	int total = 0;
+	EXPECT_EQ(damage.read(early, [&total](const Damage &d) { total += d.amount; }), 2);
+	EXPECT_EQ(total, 30);
+	EXPECT_EQ(damage.read(early, [](const Damage &) {}), 0); /* already seen */
+
+	damage.send({ 3, 30 });
+	world.update_events();
+
+	/* a reader that lagged one frame still sees both frames */
+	EXPECT_EQ(damage.read(late, [](const Damage &) {}), 3);
+	EXPECT_EQ(damage.read(early, [](const Damage &) {}), 1);
+
+	world.update_events();
+	world.update_events();
+	EXPECT_EQ(damage.size(), 0);
+
+	ncs::EventCursor stale;
+	EXPECT_EQ(damage.read(stale, [](const Damage &) {}), 0);
+}
+
+TEST(EventsTest, ConcurrentWriters)
+{
+	ncs::World world;
+	auto &damage = world.events<Damage>();
+	const ncs::EventCursor skip = damage.latest();
+
+	std::vector<std::thread> writers;
+	for (auto t = 0; t < 8; ++t)
+	{
+		writers.emplace_back([&damage, t]
+		{
+			for (auto i = 0; i < 1000; ++i)
+				damage.send({ static_cast<ncs::Entity>(t), 1 });
+		});
+	}
+	for (auto &writer: writers)
+		writer.join();
+
+	world.update_events();
+
+	ncs::EventCursor cursor = skip;
+	int total = 0;
+	damage.read(cursor, [&total](const Damage &d) { total += d.amount; });
+	EXPECT_EQ(total, 8000);
+}
+
+TEST(EventsTest, RemovedQueue)
+{
+	ncs::World world;
+	world.events<Damage>().send({ 1, 10 });
+	world.remove_resource<ncs::Events<Damage> >();
+	world.update_events(); /* must not touch the removed queue */
+
+	/* a queue created again is still updated, and only once per frame */
+	auto &damage = world.events<Damage>();
+	ncs::EventCursor cursor;
+	damage.send({ 2, 20 });
+	world.update_events();
+	EXPECT_EQ(damage.read(cursor, [](const Damage &) {}), 1);
+
+	world.set_resource<ncs::Events<Damage> >();
+	world.update_events();
+	EXPECT_EQ(world.events<Damage>().size(), 0);
+}
+
+TEST(EventsTest, ExitedThreadsReleaseSlots)
+{
+	/* far more short-lived writers than slots; each must still get a slot of its own */
+	for (std::size_t t = 0; t < 4 * ncs::Events<Damage>::MAX_WRITERS; ++t)
+		std::thread([] { ncs::thread_slot(); }).join();
+
+	std::size_t slot = ncs::Events<Damage>::MAX_WRITERS;
+	std::thread([&slot] { slot = ncs::thread_slot(); }).join();
+	EXPECT_LT(slot, ncs::Events<Damage>::MAX_WRITERS);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct OwnedBy {};
+
+class HierarchyTest : public testing::Test
+{
+protected:
+	ncs::World world;
+
+	ncs::Entity spawn(const float x)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { x, 0.0f, 0.0f });
+		return e;
+	}
+};
+
+TEST_F(HierarchyTest, PairTargets)
+{
+	const auto owner = world.entity();
+	const auto item = world.entity();
+
+	EXPECT_EQ(world.target<OwnedBy>(item), ncs::NULL_ENTITY);
+	world.pair<OwnedBy>(item, owner);
+	EXPECT_TRUE(world.has<ncs::Pair<OwnedBy> >(item));
+	EXPECT_EQ(world.target<OwnedBy>(item), owner);
+
+	world.unpair<OwnedBy>(item);
+	EXPECT_FALSE(world.has<ncs::Pair<OwnedBy> >(item));
+	EXPECT_EQ(world.target<OwnedBy>(item), ncs::NULL_ENTITY);
+}
+
+TEST_F(HierarchyTest, BreadthFirstOrder)
+{
+	/*
+	 * root
+	 * ├── a
+	 * │   └── c
+	 * └── b
+	 */
+	const auto root = spawn(1.0f);
+	const auto a = spawn(10.0f);
+	const auto b = spawn(20.0f);
+	const auto c = spawn(100.0f);
+
+	world.pair<ncs::ChildOf>(c, a);
+	world.pair<ncs::ChildOf>(a, root);
+	world.pair<ncs::ChildOf>(b, root);
+
+	const auto &h = world.query_hierarchy<Position>();
+	ASSERT_EQ(h.result.size(), 4);
+	ASSERT_EQ(h.depths.size(), 3);
+	EXPECT_EQ(h.depths[0], 0);
+	EXPECT_EQ(h.depths[1], 1);
+	EXPECT_EQ(h.depths[2], 3);
+	EXPECT_EQ(std::get<0>(h.result[0]), root);
+	EXPECT_EQ(std::get<0>(h.result[3]), c);
+	EXPECT_EQ(h.parents[0], h.NO_PARENT);
+
+	/* propagate positions top-down using the cached parent rows */
+	std::vector<float> global(h.result.size());
+	for (std::size_t i = 0; i < h.result.size(); ++i)
+	{
+		const float local = std::get<1>(h.result[i])->x;
+		global[i] = h.parents[i] == h.NO_PARENT ? local : global[h.parents[i]] + local;
+	}
+	EXPECT_EQ(global[3], 111.0f);
+
+	/* nothing changed, the same cache is served */
+	EXPECT_EQ(&world.query_hierarchy<Position>(), &h);
+	EXPECT_EQ(world.query_hierarchy<Position>().result.size(), 4);
+
+	/* re-parenting invalidates the ordering */
+	world.pair<ncs::ChildOf>(c, b);
+	const auto &moved = world.query_hierarchy<Position>();
+	ASSERT_EQ(moved.result.size(), 4);
+	EXPECT_EQ(std::get<0>(moved.result[moved.parents[3]]), b);
+}
+
+TEST_F(HierarchyTest, DespawnRecursive)
+{
+	const auto root = spawn(0.0f);
+	const auto child = spawn(1.0f);
+	const auto grandchild = spawn(2.0f);
+	const auto other = spawn(3.0f);
+
+	world.pair<ncs::ChildOf>(child, root);
+	world.pair<ncs::ChildOf>(grandchild, child);
+	world.pair<ncs::ChildOf>(other, world.entity());
+
+	world.despawn_recursive(root);
+	EXPECT_FALSE(world.has<Position>(root));
+	EXPECT_FALSE(world.has<Position>(child));
+	EXPECT_FALSE(world.has<Position>(grandchild));
+	EXPECT_TRUE(world.has<Position>(other));
+	EXPECT_EQ(world.query_hierarchy<Position>().result.size(), 1);
+	EXPECT_EQ(world.query<Position>().size(), 1);
+}
+
+TEST_F(HierarchyTest, DespawnOrphansChildren)
+{
+	const auto parent = spawn(0.0f);
+	const auto child = spawn(1.0f);
+	world.pair<ncs::ChildOf>(child, parent);
+
+	world.despawn(parent);
+	EXPECT_TRUE(world.has<Position>(child));
+	EXPECT_FALSE(world.has<ncs::Pair<ncs::ChildOf> >(child));
+	EXPECT_TRUE(world.query_hierarchy<Position>().result.empty());
+}
+
+TEST_F(HierarchyTest, RejectsCyclesAndDeadTargets)
+{
+	const auto a = spawn(0.0f);
+	const auto b = spawn(1.0f);
+	const auto c = spawn(2.0f);
+
+	EXPECT_THROW(world.pair<ncs::ChildOf>(a, a), std::invalid_argument);
+	world.pair<ncs::ChildOf>(b, a);
+	world.pair<ncs::ChildOf>(c, b);
+	EXPECT_THROW(world.pair<ncs::ChildOf>(a, b), std::invalid_argument);
+	EXPECT_THROW(world.pair<ncs::ChildOf>(a, c), std::invalid_argument);
+	EXPECT_FALSE(world.has<ncs::Pair<ncs::ChildOf> >(a));
+
+	const auto dead = world.entity();
+	world.despawn(dead);
+	EXPECT_THROW(world.pair<OwnedBy>(a, dead), ncs::InvalidEntityError);
+	EXPECT_THROW(world.pair<ncs::ChildOf>(a, dead), ncs::InvalidEntityError);
+
+	world.despawn_recursive(a);
+	EXPECT_FALSE(world.is_alive(b));
+	EXPECT_FALSE(world.is_alive(c));
+}
+
+TEST_F(HierarchyTest, ComponentWritesFollowTheHierarchy)
+{
+	const auto parent = spawn(0.0f);
+	const auto child = spawn(1.0f);
+
+	/* removing the pair like any other component detaches the child */
+	world.pair<ncs::ChildOf>(child, parent);
+	world.remove<ncs::Pair<ncs::ChildOf> >(child);
+	EXPECT_TRUE(world.query_hierarchy<Position>().result.empty());
+	world.despawn_recursive(parent);
+	EXPECT_TRUE(world.is_alive(child));
+
+	/* setting it like any other component attaches the child, with the checks of `pair()` */
+	const auto other = spawn(2.0f);
+	world.set<ncs::Pair<ncs::ChildOf> >(child, ncs::Pair<ncs::ChildOf> { other });
+	EXPECT_EQ(world.query_hierarchy<Position>().result.size(), 2);
+	EXPECT_THROW(world.set<ncs::Pair<ncs::ChildOf> >(other, ncs::Pair<ncs::ChildOf> { child }), std::invalid_argument);
+	EXPECT_THROW(world.set<ncs::Pair<ncs::ChildOf> >(other, ncs::Pair<ncs::ChildOf> { parent }), ncs::InvalidEntityError);
+	world.despawn_recursive(other);
+	EXPECT_FALSE(world.is_alive(child));
+}
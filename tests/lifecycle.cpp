@@ -1,3 +1,4 @@
+#include <thread>
 #include <unordered_set>
 #include <gtest/gtest.h>
 #include <ncs/world.hpp>
@@ -53,3 +54,95 @@ TEST_F(LifecycleTest, Respawn)
 	EXPECT_EQ(world.get_eid(reused), world.get_eid(e3));
 	EXPECT_NE(world.get_egen(reused), world.get_egen(e3));
 }
+
+TEST_F(LifecycleTest, ConcurrentReservation)
+{
+	/* leave some ids to recycle */
+	std::vector<ncs::Entity> dead;
+	for (auto i = 0; i < 100; ++i)
+		dead.emplace_back(world.entity());
+	for (const auto e: dead)
+		world.despawn(e);
+
+	std::vector<std::vector<ncs::Entity> > reserved(8);
+	std::vector<std::thread> workers;
+	for (auto t = 0; t < 8; ++t)
+	{
+		workers.emplace_back([this, &reserved, t]
+		{
+			for (auto i = 0; i < 50; ++i)
+			{
+				const auto batch = world.reserve_entities(5);
+				reserved[t].insert(reserved[t].end(), batch.begin(), batch.end());
+			}
+		});
+	}
+	for (auto &worker: workers)
+		worker.join();
+
+	world.flush_reserved();
+
+	std::unordered_set<uint64_t> ids;
+	for (const auto &batch: reserved)
+	{
+		for (const auto e: batch)
+		{
+			EXPECT_TRUE(ids.insert(ncs::World::get_eid(e)).second);
+			world.set<int>(e, static_cast<int>(ncs::World::get_eid(e)));
+		}
+	}
+	EXPECT_EQ(ids.size(), 8 * 50 * 5);
+	EXPECT_EQ(world.query<int>().size(), 8 * 50 * 5);
+
+	/* every recycled id was used, so the stale handles stay stale */
+	for (const auto e: dead)
+		EXPECT_FALSE(world.has<int>(e));
+
+	/* fresh allocations continue after the reserved range */
+	const auto next = world.entity();
+	EXPECT_FALSE(ids.contains(ncs::World::get_eid(next)));
+}
+
+TEST_F(LifecycleTest, ReserveThenSpawn)
+{
+	const auto reserved = world.reserve_entities(3);
+	const auto spawned = world.entity(); /* sync point */
+
+	std::unordered_set<uint64_t> ids = { ncs::World::get_eid(spawned) };
+	for (const auto e: reserved)
+	{
+		ids.insert(ncs::World::get_eid(e));
+		world.set<int>(e, 1);
+		EXPECT_TRUE(world.has<int>(e));
+	}
+	EXPECT_EQ(ids.size(), 4);
+
+	world.despawn(reserved[1]);
+	EXPECT_FALSE(world.has<int>(reserved[1]));
+	EXPECT_TRUE(world.has<int>(reserved[2]));
+}
+
+TEST_F(LifecycleTest, StaleHandles)
+{
+	const auto e = world.entity();
+	world.set<int>(e, 7);
+	EXPECT_TRUE(world.is_alive(e));
+
+	world.despawn(e);
+	EXPECT_FALSE(world.is_alive(e));
+	EXPECT_FALSE(world.is_alive(ncs::NULL_ENTITY));
+
+	/* the id comes back under a new generation; the old handle must not reach it */
+	const auto reused = world.entity();
+	world.set<int>(reused, 42);
+	ASSERT_EQ(world.get_eid(reused), world.get_eid(e));
+	EXPECT_TRUE(world.is_alive(reused));
+	EXPECT_FALSE(world.is_alive(e));
+
+	EXPECT_FALSE(world.has<int>(e));
+	EXPECT_THROW(world.set<int>(e, 0), ncs::InvalidEntityError);
+	EXPECT_THROW(world.get<int>(e), ncs::InvalidEntityError);
+	EXPECT_EQ(*world.get<int>(reused), 42);
+	EXPECT_THROW(world.remove<int>(e), ncs::InvalidEntityError);
+	EXPECT_THROW(world.despawn(e), ncs::InvalidEntityError);
+}
@@ -0,0 +1,279 @@
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Name
+{
+	std::string name;
+
+	Name() = default;
+
+	Name(std::string s) : name(std::move(s)) {}
+};
+
+class MemoryTest : public testing::Test
+{
+protected:
+	ncs::World world;
+};
+
+TEST_F(MemoryTest, CompactReleasesDeadCapacity)
+{
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 1000; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Name>(e, Name { "entity" + std::to_string(i) });
+		entities.push_back(e);
+	}
+
+	/* keep a handful alive; their data must survive the shrink */
+	for (auto i = 10; i < 1000; ++i)
+		world.despawn(entities[i]);
+
+	EXPECT_GT(world.compact(), 0);
+	EXPECT_EQ(world.compact(), 0); /* nothing left to give back */
+
+	for (auto i = 0; i < 10; ++i)
+	{
+		const auto *pos = world.get<Position>(entities[i]);
+		const auto *name = world.get<Name>(entities[i]);
+		ASSERT_NE(pos, nullptr);
+		ASSERT_NE(name, nullptr);
+		EXPECT_EQ(pos->x, static_cast<float>(i));
+		EXPECT_EQ(name->name, "entity" + std::to_string(i));
+	}
+
+	EXPECT_EQ((world.query<Position, Name>().size()), 10);
+}
+
+TEST_F(MemoryTest, CompactReleasesEmptyArchetypes)
+{
+	const auto e = world.entity();
+	world.set<Position>(e, { 1.0f, 2.0f, 3.0f });
+	world.set<Velocity>(e, { 4.0f, 5.0f, 6.0f });
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 1);
+
+	world.remove<Velocity>(e);
+	EXPECT_GT(world.compact(), 0);
+
+	/* the released archetype and its edges are recreated on demand */
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 0);
+	world.set<Velocity>(e, { 7.0f, 8.0f, 9.0f });
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 1);
+	EXPECT_EQ(world.get<Position>(e)->x, 1.0f);
+	EXPECT_EQ(world.get<Velocity>(e)->x, 7.0f);
+}
+
+TEST_F(MemoryTest, AutomaticCompaction)
+{
+	world.set_compaction_policy({ .automatic = true, .interval = 8 });
+
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 64; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		entities.push_back(e);
+	}
+
+	for (auto i = 0; i < 63; ++i)
+		world.despawn(entities[i]);
+
+	/* the last pass ran on the 56th despawn; only the rows dropped since remain */
+	EXPECT_LT(world.compact(), 64 * sizeof(Position));
+	EXPECT_EQ(world.get<Position>(entities[63])->x, 63.0f);
+}
+
+TEST_F(MemoryTest, Stats)
+{
+	for (auto i = 0; i < 100; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		if (i % 2 == 0)
+			world.set<Velocity>(e, Velocity { 0.0f, static_cast<float>(i), 0.0f });
+	}
+	world.query<Position, Velocity>();
+
+	const ncs::WorldStats stats = world.stats();
+	EXPECT_EQ(stats.entities.alive, 100);
+	EXPECT_EQ(stats.entities.recyclable, 0);
+	ASSERT_EQ(stats.queries.size(), 1);
+	EXPECT_EQ(stats.queries[0].entries, 50);
+	EXPECT_GE(stats.queries[0].bytes, 50 * sizeof(std::tuple<ncs::Entity, Position *, Velocity *>));
+
+	std::size_t entities = 0;
+	std::size_t reserved = 0;
+	for (const auto &archetype: stats.archetypes)
+	{
+		EXPECT_GE(archetype.capacity, archetype.entity_count);
+		EXPECT_GE(archetype.bytes_reserved, archetype.bytes_used);
+		if (archetype.components.size() == 2)
+		{
+			EXPECT_EQ(archetype.bytes_used, 50 * (sizeof(ncs::Entity) + sizeof(Position) + sizeof(Velocity)));
+		}
+
+		entities += archetype.entity_count;
+		reserved += archetype.bytes_reserved;
+	}
+
+	EXPECT_EQ(entities, 100);
+	EXPECT_GE(stats.bytes_reserved, reserved);
+	EXPECT_GT(stats.map_overhead, 0);
+	EXPECT_EQ(stats.total_bytes, stats.bytes_reserved + stats.query_bytes + stats.map_overhead);
+}
+
+TEST_F(MemoryTest, Reserve)
+{
+	world.reserve<Position>(16);
+	world.reserve<Position, Velocity>(5000);
+
+	const auto capacity_of = [this](const std::size_t components)
+	{
+		for (const auto &a: world.stats().archetypes)
+		{
+			if (a.components.size() == components)
+				return a.capacity;
+		}
+		return std::size_t { 0 };
+	};
+	EXPECT_GE(capacity_of(2), 5000);
+
+	/* a level of a known shape loads without regrowing anything */
+	ncs::reset_counters();
+	for (auto i = 0; i < 5000; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+	}
+	EXPECT_EQ(capacity_of(2), 5000);
+	if constexpr (ncs::COUNTERS_ENABLED)
+	{
+		EXPECT_EQ(ncs::counters().column_reallocs, 0);
+	}
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 5000);
+}
+
+TEST_F(MemoryTest, GrowthPolicy)
+{
+	world.set_growth_policy({ .initial_rows = 4, .factor = 1.5 });
+
+	std::vector<std::size_t> capacities;
+	for (auto i = 0; i < 20; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position {});
+		for (const auto &a: world.stats().archetypes)
+		{
+			if (!a.components.empty() && (capacities.empty() || capacities.back() != a.capacity))
+				capacities.emplace_back(a.capacity);
+		}
+	}
+
+	const std::vector<std::size_t> expected = { 4, 6, 9, 13, 19, 28 };
+	EXPECT_EQ(capacities, expected);
+}
+
+TEST_F(MemoryTest, MappedColumns)
+{
+	world.set_growth_policy({ .backend = ncs::ColumnBackend::MAPPED, .mapped_reserve = std::size_t { 16 } << 20 });
+
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 20000; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Name>(e, Name { "entity_" + std::to_string(i) });
+		entities.emplace_back(e);
+	}
+
+	for (auto i = 0; i < 20000; i += 2)
+		world.despawn(entities[i]);
+	world.compact();
+
+	std::size_t rows = 0;
+	for (const auto &[e, pos, name]: world.query<Position, Name>())
+	{
+		EXPECT_EQ(name->name, "entity_" + std::to_string(static_cast<int>(pos->x)));
+		++rows;
+	}
+	EXPECT_EQ(rows, 10000);
+}
+
+TEST_F(MemoryTest, ColdArchetypes)
+{
+	std::vector<ncs::Entity> cold;
+	for (auto i = 0; i < 1000; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Name>(e, Name { "entity_" + std::to_string(i) });
+		cold.emplace_back(e);
+	}
+	const auto hot = world.entity();
+	world.set<Position>(hot, Position { -1.0f, 0.0f, 0.0f });
+
+	EXPECT_EQ((world.query<Position>().size()), 1001);
+	world.make_cold<Position, Name>(std::filesystem::temp_directory_path().string());
+
+	/* cold rows drop out of queries but stay addressable */
+	EXPECT_EQ((world.query<Position>().size()), 1);
+	EXPECT_EQ((world.query<Position>(true).size()), 1001);
+	EXPECT_EQ((world.chunks<Position>().size()), 1);
+	EXPECT_EQ((world.chunks<Position>(true).size()), 2);
+	EXPECT_EQ(world.get<Name>(cold[42])->name, "entity_42");
+
+	world.set<Position>(cold[42], Position { 7.0f, 0.0f, 0.0f });
+	EXPECT_EQ(world.get<Position>(cold[42])->x, 7.0f);
+
+	/* new rows land in the file-backed columns too */
+	const auto late = world.entity();
+	world.set<Position>(late, Position { 5.0f, 0.0f, 0.0f });
+	world.set<Name>(late, Name { "late" });
+	EXPECT_EQ(world.get<Name>(late)->name, "late");
+	EXPECT_EQ((world.query<Position>().size()), 1);
+	EXPECT_EQ((world.query<Position>(true).size()), 1002);
+
+	world.make_hot<Position, Name>();
+	EXPECT_EQ((world.query<Position>().size()), 1002);
+
+	std::size_t rows = 0;
+	for (const auto &[e, pos, name]: world.query<Position, Name>())
+	{
+		if (e == cold[42])
+		{
+			EXPECT_EQ(pos->x, 7.0f);
+		}
+		else if (e != late)
+		{
+			EXPECT_EQ(name->name, "entity_" + std::to_string(static_cast<int>(pos->x)));
+		}
+		++rows;
+	}
+	EXPECT_EQ(rows, 1001);
+}
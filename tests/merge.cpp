@@ -0,0 +1,121 @@
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Name
+{
+	std::string name;
+
+	Name() = default;
+
+	Name(std::string s) : name(std::move(s)) {}
+};
+
+struct OwnedBy {};
+
+TEST(MergeTest, SpliceAndAdopt)
+{
+	ncs::World world;
+	const auto existing = world.entity();
+	world.set<Position>(existing, Position { 1.0f, 0.0f, 0.0f });
+
+	/* the level is built on a worker thread, as it would be when streaming */
+	ncs::World level;
+	std::vector<ncs::Entity> spawned;
+	std::thread loader([&level, &spawned]
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			const auto e = level.entity();
+			level.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+			if (i % 2 == 0)
+				level.set<Name>(e, Name { "streamed_" + std::to_string(i) });
+			spawned.emplace_back(e);
+		}
+	});
+	loader.join();
+
+	size_t added = 0;
+	world.on_add<Position>([&added](const ncs::Entity, const Position *) { ++added; });
+
+	world.merge(std::move(level));
+	EXPECT_EQ(added, 8);
+	EXPECT_EQ((world.query<Position>().size()), 9);
+	EXPECT_EQ((world.query<Position, Name>().size()), 4);
+
+	for (auto &[e, name]: world.query<Name>())
+		EXPECT_EQ(name->name.rfind("streamed_", 0), 0);
+
+	/* merged entities are regular members of the world */
+	const auto *pos = world.get<Position>(existing);
+	ASSERT_NE(pos, nullptr);
+	EXPECT_EQ(*pos, Position(1.0f, 0.0f, 0.0f));
+}
+
+TEST(MergeTest, RemapsRelations)
+{
+	ncs::World world;
+	/* occupy the low ids so the merged ones cannot line up by accident */
+	const auto first = world.entity();
+	world.set<Position>(first, Position { 5.0f, 0.0f, 0.0f });
+	world.despawn(first);
+
+	ncs::World level;
+	const auto root = level.entity();
+	level.set<Position>(root, Position { 1.0f, 0.0f, 0.0f });
+	const auto child = level.entity();
+	level.set<Position>(child, Position { 2.0f, 0.0f, 0.0f });
+	level.pair<ncs::ChildOf>(child, root);
+	level.pair<OwnedBy>(child, root);
+
+	world.merge(std::move(level));
+
+	/* find the merged entities again by their data */
+	ncs::Entity new_root = ncs::NULL_ENTITY, new_child = ncs::NULL_ENTITY;
+	for (auto &[e, pos]: world.query<Position>())
+		(pos->x == 1.0f ? new_root : new_child) = e;
+	ASSERT_NE(new_root, ncs::NULL_ENTITY);
+	ASSERT_NE(new_child, ncs::NULL_ENTITY);
+
+	EXPECT_EQ(world.target<OwnedBy>(new_child), new_root);
+	EXPECT_EQ(world.target<ncs::ChildOf>(new_child), new_root);
+
+	world.despawn_recursive(new_root);
+	EXPECT_FALSE(world.has<Position>(new_child));
+	EXPECT_EQ((world.query<Position>().size()), 0);
+}
+
+TEST(MergeTest, DropsLinksToDeadParents)
+{
+	ncs::World world;
+	ncs::World level;
+	const auto a = level.entity();
+	level.set<Position>(a, Position { 1.0f, 0.0f, 0.0f });
+	const auto b = level.entity();
+	level.despawn(b);
+
+	/* a deferred pair to a dead parent is dropped, so nothing dangling reaches the merge */
+	ncs::Commands commands(level);
+	commands.set<ncs::Pair<ncs::ChildOf> >(a, ncs::Pair<ncs::ChildOf> { b });
+	level.apply(commands);
+	EXPECT_EQ(level.target<ncs::ChildOf>(a), ncs::NULL_ENTITY);
+
+	EXPECT_NO_THROW(world.merge(std::move(level)));
+	const auto merged = world.query<Position>();
+	ASSERT_EQ(merged.size(), 1);
+	const auto e = std::get<ncs::Entity>(merged.front());
+	EXPECT_EQ(world.target<ncs::ChildOf>(e), ncs::NULL_ENTITY);
+	EXPECT_TRUE(world.query_hierarchy<Position>().result.empty());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class ObserverTest : public testing::Test
+{
+protected:
+	ncs::World world;
+	std::vector<std::pair<ncs::Entity, float> > added, updated, removed;
+
+	void SetUp() override
+	{
+		world.on_add<Position>([this](const ncs::Entity e, const Position *pos)
+		{
+			added.emplace_back(e, pos->x);
+		});
+		world.on_set<Position>([this](const ncs::Entity e, const Position *pos)
+		{
+			updated.emplace_back(e, pos->x);
+		});
+		world.on_remove<Position>([this](const ncs::Entity e, const Position *pos)
+		{
+			removed.emplace_back(e, pos->x);
+		});
+	}
+};
+
+TEST_F(ObserverTest, SetAndRemove)
+{
+	const auto e = world.entity();
+	world.set<Position>(e, { 1.0f, 0.0f, 0.0f });
+	ASSERT_EQ(added.size(), 1);
+	ASSERT_EQ(updated.size(), 1);
+	EXPECT_EQ(added[0], std::make_pair(e, 1.0f));
+
+	world.set<Position>(e, Position { 2.0f, 0.0f, 0.0f });
+	EXPECT_EQ(added.size(), 1);
+	ASSERT_EQ(updated.size(), 2);
+	EXPECT_EQ(updated[1], std::make_pair(e, 2.0f));
+
+	/* migrating for another component neither adds nor removes `Position` */
+	world.set<Velocity>(e, { 0.0f, 1.0f, 0.0f });
+	EXPECT_EQ(added.size(), 1);
+	EXPECT_TRUE(removed.empty());
+
+	world.remove<Position>(e);
+	ASSERT_EQ(removed.size(), 1);
+	EXPECT_EQ(removed[0], std::make_pair(e, 2.0f));
+
+	world.remove<Velocity>(e);
+	EXPECT_EQ(removed.size(), 1);
+}
+
+TEST_F(ObserverTest, Despawn)
+{
+	const auto e1 = world.entity();
+	const auto e2 = world.entity();
+	world.set<Position>(e1, { 1.0f, 0.0f, 0.0f });
+	world.set<Position>(e2, { 2.0f, 0.0f, 0.0f });
+	world.set<Velocity>(e2, { 0.0f, 0.0f, 0.0f });
+
+	world.despawn(e2);
+	ASSERT_EQ(removed.size(), 1);
+	EXPECT_EQ(removed[0], std::make_pair(e2, 2.0f));
+}
+
+TEST_F(ObserverTest, BatchedInstantiate)
+{
+	std::vector<std::size_t> batches;
+	world.on_add<Position>([&batches](const std::span<const ncs::Entity> entities, const std::span<Position> positions)
+	{
+		EXPECT_EQ(entities.size(), positions.size());
+		batches.emplace_back(entities.size());
+	});
+
+	const auto prefab = world.entity();
+	world.set<Position>(prefab, { 5.0f, 0.0f, 0.0f });
+	const auto instances = world.instantiate(prefab, 64);
+
+	ASSERT_EQ(batches.size(), 2); /* the prefab itself, then one batch for every copy */
+	EXPECT_EQ(batches[1], 64);
+	EXPECT_EQ(added.size(), 65);
+	EXPECT_EQ(added.back(), std::make_pair(instances.back(), 5.0f));
+}
+
+TEST_F(ObserverTest, Unobserve)
+{
+	std::size_t calls = 0;
+	const auto handle = world.on_set<Position>([&calls](ncs::Entity, Position *) { ++calls; });
+
+	const auto e = world.entity();
+	world.set<Position>(e, { 1.0f, 0.0f, 0.0f });
+	EXPECT_EQ(calls, 1);
+
+	world.unobserve(handle);
+	world.unobserve(handle); /* already gone */
+	world.set<Position>(e, { 2.0f, 0.0f, 0.0f });
+	EXPECT_EQ(calls, 1);
+	EXPECT_EQ(updated.size(), 2); /* the other observers stay */
+}
@@ -1,3 +1,5 @@
+#include <limits>
+#include <unordered_set>
 #include <gtest/gtest.h>
 #include <ncs/world.hpp>
 
@@ -337,3 +339,159 @@ TEST(WorldTest, LargeQuery)
 	const auto q4 = world.query<Position, Velocity, Health>();
 	EXPECT_EQ(q4.size(), 1000 / 15 + (1000 % 15 > 0 ? 1 : 0));
 }
+
+TEST(WorldTest, ChunkSpans)
+{
+	ncs::World world;
+	for (auto i = 0; i < 100; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+		if (i % 4 == 0)
+			world.set<Health>(e, Health { i });
+	}
+
+	std::size_t rows = 0;
+	for (const auto &chunk: world.chunks<Position, Velocity>())
+	{
+		const auto pos = chunk.get<Position>();
+		const auto vel = chunk.get<Velocity>();
+		ASSERT_EQ(pos.size(), chunk.count);
+		ASSERT_EQ(vel.size(), chunk.count);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pos.data()) % ncs::Column::ALIGNMENT, 0);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(vel.data()) % ncs::Column::ALIGNMENT, 0);
+
+		for (std::size_t i = 0; i < chunk.count; ++i)
+			pos[i].x += vel[i].x;
+		rows += chunk.count;
+	}
+	EXPECT_EQ(rows, 100);
+
+	/* the spans alias the same storage `query()` hands out */
+	float sum = 0.0f;
+	for (const auto &[e, pos]: world.query<Position>())
+		sum += pos->x;
+	EXPECT_EQ(sum, 100.0f * 99.0f / 2.0f + 100.0f);
+
+	EXPECT_EQ(world.chunks<Health>().size(), 1);
+	EXPECT_EQ(world.chunks<Health>()[0].count, 25);
+}
+
+TEST(WorldTest, SortBy)
+{
+	ncs::World world;
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 64; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Health>(e, Health { (i * 37) % 64 });
+		world.set<Velocity>(e, Velocity { static_cast<float>((i * 37) % 64), 0.0f, 0.0f });
+		entities.emplace_back(e);
+	}
+
+	const auto by_value = [](const Health &a, const Health &b) { return a.value < b.value; };
+	const auto expect_sorted = [&world]
+	{
+		int last = std::numeric_limits<int>::min();
+		for (const auto &[e, health, vel]: world.query<Health, Velocity>())
+		{
+			EXPECT_LE(last, health->value);
+			EXPECT_EQ(vel->x, static_cast<float>(health->value)); /* rows moved as a whole */
+			last = health->value;
+		}
+	};
+
+	world.sort_by<Health>(by_value);
+	expect_sorted();
+
+	/* a few changes and a late arrival only displace a handful of rows */
+	world.get<Health>(entities[3])->value = 1000;
+	world.get<Velocity>(entities[3])->x = 1000.0f;
+	const auto late = world.entity();
+	world.set<Health>(late, Health { -5 });
+	world.set<Velocity>(late, Velocity { -5.0f, 0.0f, 0.0f });
+
+	world.sort_by<Health>(by_value);
+	expect_sorted();
+	EXPECT_EQ(std::get<0>(world.query<Health>().front()), late);
+	EXPECT_EQ(std::get<0>(world.query<Health>().back()), entities[3]);
+
+	/* records follow the rows */
+	for (const auto e: entities)
+		EXPECT_EQ(static_cast<float>(world.get<Health>(e)->value), world.get<Velocity>(e)->x);
+}
+
+TEST(WorldTest, SignatureHashing)
+{
+	/* trailing zero ids fall into the padding of the last word; the length keeps them apart */
+	EXPECT_NE(ncs::archash({ 1 }), ncs::archash({ 1, 0 }));
+	EXPECT_NE(ncs::archash({ 1, 2, 3, 4 }), ncs::archash({ 1, 2, 3, 4, 0 }));
+	EXPECT_NE(ncs::archash({ 1, 2 }), ncs::archash({ 2, 1 }));
+
+	std::unordered_set<std::uint64_t> hashes;
+	std::size_t signatures = 0;
+	for (ncs::Component a = 0; a < 64; ++a)
+	{
+		for (ncs::Component b = a + 1; b < 64; ++b)
+		{
+			for (ncs::Component c = b + 1; c < 64; c += 7)
+			{
+				hashes.insert(ncs::archash({ a, b, c }));
+				hashes.insert(ncs::archash({ a, b, c, static_cast<ncs::Component>(c + 1), 500 }));
+				signatures += 2;
+			}
+		}
+	}
+	EXPECT_EQ(hashes.size(), signatures);
+
+	/* a query cache is found by its type, so reordered terms get a cache of their own */
+	ncs::World world;
+	const auto e = world.entity();
+	world.set<Position>(e, Position { 1.0f, 0.0f, 0.0f });
+	world.set<Velocity>(e, Velocity { 2.0f, 0.0f, 0.0f });
+	EXPECT_EQ(std::get<1>(world.query<Position, Velocity>()[0])->x, 1.0f);
+	EXPECT_EQ(std::get<1>(world.query<Velocity, Position>()[0])->x, 2.0f);
+}
+
+TEST(WorldTest, OverlappingQueries)
+{
+	ncs::World world;
+	for (auto i = 0; i < 10; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { static_cast<float>(i), 0.0f, 0.0f });
+		world.set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+	}
+
+	/* both caches cover {Position, Velocity}; refreshing one must not hide changes from the other */
+	EXPECT_EQ((world.query<Position>().size()), 10);
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 10);
+
+	const auto added = world.entity();
+	world.set<Position>(added, Position { 100.0f, 0.0f, 0.0f });
+	world.set<Velocity>(added, Velocity { 1.0f, 0.0f, 0.0f });
+	EXPECT_EQ((world.query<Position>().size()), 11);
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 11);
+
+	const auto victim = std::get<0>(world.query<Position, Velocity>()[3]);
+	world.despawn(victim);
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 10);
+	EXPECT_EQ((world.query<Position>().size()), 10);
+
+	/* a value write keeps every cached pointer valid */
+	world.set<Position>(added, Position { 200.0f, 0.0f, 0.0f });
+	float sum = 0.0f;
+	for (const auto &[e, pos, vel]: world.query<Position, Velocity>())
+	{
+		EXPECT_NE(e, victim);
+		sum += pos->x;
+	}
+	EXPECT_EQ(sum, 45.0f - 3.0f + 200.0f);
+
+	/* a new matching archetype joins existing caches */
+	const auto tagged = world.entity();
+	world.set<Position>(tagged, Position { 0.0f, 0.0f, 0.0f });
+	world.set<Health>(tagged, Health { 1 });
+	EXPECT_EQ((world.query<Position>().size()), 11);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Time
+{
+	double delta = 0.0;
+	double elapsed = 0.0;
+};
+
+struct Config
+{
+	std::string name;
+	static inline int destroyed = 0;
+
+	Config(std::string n) : name(std::move(n)) {}
+
+	~Config()
+	{
+		++destroyed;
+	}
+};
+
+TEST(ResourceTest, SetGetRemove)
+{
+	ncs::World world;
+	EXPECT_EQ(world.resource<Time>(), nullptr);
+
+	world.set_resource<Time>(Time { 0.016, 1.0 });
+	ASSERT_NE(world.resource<Time>(), nullptr);
+	EXPECT_EQ(world.resource<Time>()->delta, 0.016);
+
+	world.resource<Time>()->elapsed += 0.016;
+	EXPECT_EQ(world.resource<Time>()->elapsed, 1.016);
+
+	world.remove_resource<Time>();
+	EXPECT_EQ(world.resource<Time>(), nullptr);
+}
+
+TEST(ResourceTest, Lifetime)
+{
+	Config::destroyed = 0;
+	{
+		ncs::World world;
+		world.set_resource<Config>("first");
+		world.set_resource<Config>("second"); /* replaces and destroys the first one */
+		EXPECT_EQ(Config::destroyed, 1);
+		EXPECT_EQ(world.resource<Config>()->name, "second");
+
+		/* resources are per world */
+		ncs::World other;
+		EXPECT_EQ(other.resource<Config>(), nullptr);
+	}
+	EXPECT_EQ(Config::destroyed, 2);
+}
+
+TEST(ResourceTest, AccessConflicts)
+{
+	ncs::World world;
+
+	const ncs::Access physics = world.access<ncs::Write<Position>, ncs::Read<Velocity>, ncs::ReadResource<Time> >();
+	const ncs::Access render = world.access<ncs::Read<Position> >();
+	const ncs::Access damping = world.access<ncs::Write<Velocity> >();
+	const ncs::Access clock = world.access<ncs::WriteResource<Time> >();
+	const ncs::Access audio = world.access<ncs::ReadResource<Time>, ncs::ReadResource<Config> >();
+
+	EXPECT_TRUE(physics.conflicts(render));
+	EXPECT_TRUE(physics.conflicts(damping));
+	EXPECT_TRUE(physics.conflicts(clock));
+	EXPECT_FALSE(render.conflicts(damping));
+	EXPECT_FALSE(physics.conflicts(audio)); /* readers never conflict */
+	EXPECT_TRUE(audio.conflicts(clock));
+}
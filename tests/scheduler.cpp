@@ -0,0 +1,217 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+#include <addons/scheduler.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct Velocity
+{
+	float x, y, z;
+	Velocity(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Velocity &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class SchedulerTest : public testing::Test
+{
+protected:
+	ncs::World world;
+};
+
+TEST_F(SchedulerTest, ConflictingSystemsRunInOrder)
+{
+	for (auto i = 0; i < 10; ++i)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position {});
+		world.set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+	}
+
+	ncs::Scheduler scheduler(world, 4);
+	std::atomic<int> sequence = 0;
+	int moved = -1;
+	int rendered = -1;
+
+	scheduler.add("movement", world.access<ncs::Write<Position>, ncs::Read<Velocity> >(), [&](ncs::World &w)
+	{
+		for (const auto &chunk: w.chunks<Position, Velocity>())
+		{
+			const auto pos = chunk.get<Position>();
+			const auto vel = chunk.get<Velocity>();
+			for (std::size_t i = 0; i < chunk.count; ++i)
+				pos[i].x += vel[i].x;
+		}
+		moved = sequence++;
+	});
+	scheduler.add("render", world.access<ncs::Read<Position> >(), [&](ncs::World &)
+	{
+		rendered = sequence++;
+	});
+
+	scheduler.run();
+	EXPECT_LT(moved, rendered);
+	for (auto &[e, pos]: world.query<Position>())
+		EXPECT_EQ(pos->x, 1.0f);
+}
+
+TEST_F(SchedulerTest, ReadersShareAQueryInOneWave)
+{
+	ncs::Scheduler scheduler(world, 4);
+	std::atomic<std::size_t> seen = 0;
+	std::atomic<int> started = 0;
+	for (auto i = 0; i < 4; ++i)
+	{
+		scheduler.add("reader " + std::to_string(i), world.access<ncs::Read<Position> >(), [&](ncs::World &w)
+		{
+			/* hold each thread until the others have picked up a reader too, so the queries really overlap */
+			++started;
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+			while (started % 4 != 0 && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::yield();
+			seen += w.query<Position>().size();
+		});
+	}
+
+	/* every frame starts with a stale cache that the readers refresh at the same time */
+	for (std::size_t frame = 1; frame <= 8; ++frame)
+	{
+		world.set<Position>(world.entity(), Position {});
+		seen = 0;
+		scheduler.run();
+		EXPECT_EQ(seen, 4 * frame);
+	}
+}
+
+TEST_F(SchedulerTest, ProfilingIsOffByDefault)
+{
+	ncs::Scheduler scheduler(world, 2);
+	const auto system = scheduler.add("idle", world.access<>(), [](ncs::World &) {});
+	scheduler.run();
+
+	EXPECT_FALSE(scheduler.profiling());
+	EXPECT_EQ(scheduler.timing(system).runs, 0);
+
+	std::ostringstream trace;
+	scheduler.write_trace(trace);
+	EXPECT_EQ(trace.str().find("\"ph\":\"X\""), std::string::npos);
+}
+
+TEST_F(SchedulerTest, ChromeTrace)
+{
+	ncs::Scheduler scheduler(world, 4);
+	scheduler.set_profiling(true);
+
+	std::vector<std::size_t> sleepers;
+	for (auto i = 0; i < 4; ++i)
+	{
+		sleepers.emplace_back(scheduler.add("sleep \"" + std::to_string(i) + "\"", world.access<>(), [](ncs::World &)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			return 7;
+		}));
+	}
+
+	scheduler.run();
+	scheduler.run();
+
+	std::set<std::uint32_t> threads;
+	for (const auto system: sleepers)
+	{
+		const ncs::SystemTiming &timing = scheduler.timing(system);
+		EXPECT_EQ(timing.runs, 2);
+		EXPECT_EQ(timing.entities, 7);
+		EXPECT_GE(timing.total_ns, 2 * 20'000'000ull);
+		threads.insert(timing.thread);
+	}
+	EXPECT_GT(threads.size(), 1); /* independent systems spread over the pool */
+
+	std::ostringstream trace;
+	scheduler.write_trace(trace);
+	const std::string json = trace.str();
+	EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+	EXPECT_NE(json.find("\"name\":\"sleep \\\"0\\\"\""), std::string::npos);
+	EXPECT_NE(json.find("\"args\":{\"entities\":7}"), std::string::npos);
+
+	std::size_t spans = 0;
+	for (std::size_t at = json.find("\"ph\":\"X\""); at != std::string::npos; at = json.find("\"ph\":\"X\"", at + 1))
+		++spans;
+	EXPECT_EQ(spans, 8);
+
+	scheduler.clear_trace();
+	std::ostringstream cleared;
+	scheduler.write_trace(cleared);
+	EXPECT_EQ(cleared.str().find("\"ph\":\"X\""), std::string::npos);
+}
+
+TEST_F(SchedulerTest, StagesFlushCommands)
+{
+	ncs::Scheduler scheduler(world, 4);
+	std::size_t seen_in_update = 0;
+	std::size_t seen_in_post_update = 0;
+	std::atomic<int> started = 0;
+	std::mutex lock;
+	std::set<std::thread::id> spawned_on;
+
+	/*
+	 * two spawners in one wave, each recording into its own thread's buffer. they only defer their
+	 * writes, so they declare no access and never conflict; each waits for the other to start so the
+	 * two really run on separate threads
+	 */
+	for (auto i = 0; i < 2; ++i)
+	{
+		scheduler.add(ncs::Stage::UPDATE, "spawn", world.access<>(),
+		              [&](ncs::World &, ncs::Commands &commands)
+		              {
+			              ++started;
+			              const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+			              while (started % 2 != 0 && std::chrono::steady_clock::now() < deadline)
+				              std::this_thread::yield();
+			              {
+				              std::lock_guard guard(lock);
+				              spawned_on.insert(std::this_thread::get_id());
+			              }
+
+			              for (auto n = 0; n < 50; ++n)
+			              {
+				              const auto e = commands.spawn();
+				              commands.set<Position>(e, Position {})->set<Velocity>(e, Velocity { 1.0f, 0.0f, 0.0f });
+			              }
+		              });
+	}
+	scheduler.add(ncs::Stage::UPDATE, "count", world.access<ncs::Read<Position> >(), [&](ncs::World &w)
+	{
+		seen_in_update = w.query<Position>().size();
+	});
+	scheduler.add(ncs::Stage::POST_UPDATE, "count", world.access<ncs::Read<Position> >(), [&](ncs::World &w)
+	{
+		seen_in_post_update = w.query<Position>().size();
+	});
+
+	scheduler.run();
+	EXPECT_EQ(spawned_on.size(), 2);
+	EXPECT_EQ(seen_in_update, 0); /* nothing lands before the stage ends */
+	EXPECT_EQ(seen_in_post_update, 100);
+	EXPECT_EQ((world.query<Position, Velocity>().size()), 100);
+
+	scheduler.run();
+	EXPECT_EQ(seen_in_update, 100);
+	EXPECT_EQ(seen_in_post_update, 200);
+}
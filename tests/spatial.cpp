@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <gtest/gtest.h>
+#include <ncs/world.hpp>
+#include <addons/spatial.hpp>
+
+struct Position
+{
+	float x, y, z;
+	Position(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+	bool operator==(const Position &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+class SpatialTest : public testing::Test
+{
+protected:
+	ncs::World world;
+
+	ncs::Entity spawn(const float x, const float y)
+	{
+		const auto e = world.entity();
+		world.set<Position>(e, Position { x, y, 0.0f });
+		return e;
+	}
+
+	static bool contains(const std::vector<ncs::Entity> &found, const ncs::Entity e)
+	{
+		return std::ranges::find(found, e) != found.end();
+	}
+};
+
+TEST_F(SpatialTest, RadiusAndBox)
+{
+	const auto existing = spawn(0.5f, 0.5f); /* picked up when the grid is built */
+	ncs::SpatialGrid<Position> grid(world, 4.0f);
+
+	const auto near = spawn(3.0f, 0.0f);
+	const auto far = spawn(30.0f, -30.0f);
+	const auto negative = spawn(-2.0f, -2.0f);
+	EXPECT_EQ(grid.size(), 4);
+
+	std::vector<ncs::Entity> found;
+	grid.radius(0.0f, 0.0f, 5.0f, found);
+	EXPECT_EQ(found.size(), 3);
+	EXPECT_TRUE(contains(found, existing));
+	EXPECT_TRUE(contains(found, near));
+	EXPECT_TRUE(contains(found, negative));
+
+	found.clear();
+	grid.aabb(20.0f, -40.0f, 40.0f, -20.0f, found);
+	ASSERT_EQ(found.size(), 1);
+	EXPECT_EQ(found[0], far);
+}
+
+TEST_F(SpatialTest, IncrementalUpdates)
+{
+	ncs::SpatialGrid<Position> grid(world, 1.0f);
+	std::vector<ncs::Entity> entities;
+	for (auto i = 0; i < 100; ++i)
+		entities.emplace_back(spawn(static_cast<float>(i), 0.0f));
+
+	/* moving through `set()` relocates the entity between cells */
+	world.set<Position>(entities[10], Position { 50.5f, 0.0f, 0.0f });
+
+	std::vector<ncs::Entity> found;
+	grid.radius(50.5f, 0.0f, 0.6f, found);
+	EXPECT_EQ(found.size(), 3);
+	EXPECT_TRUE(contains(found, entities[10]));
+
+	/* writes through pointers need a touch */
+	world.get<Position>(entities[20])->x = -100.0f;
+	grid.touch(entities[20]);
+	found.clear();
+	grid.radius(-100.0f, 0.0f, 1.0f, found);
+	ASSERT_EQ(found.size(), 1);
+	EXPECT_EQ(found[0], entities[20]);
+
+	/* removal and despawn drop entities from the grid */
+	world.remove<Position>(entities[20]);
+	world.despawn(entities[10]);
+	EXPECT_EQ(grid.size(), 98);
+	found.clear();
+	grid.aabb(-200.0f, -1.0f, 200.0f, 1.0f, found);
+	EXPECT_EQ(found.size(), 98);
+	EXPECT_FALSE(contains(found, entities[10]));
+	EXPECT_FALSE(contains(found, entities[20]));
+}
+
+TEST_F(SpatialTest, HugeRangesAndTeardown)
+{
+	std::vector<ncs::Entity> entities;
+	{
+		ncs::SpatialGrid<Position> grid(world, 0.001f);
+		entities.emplace_back(spawn(0.0f, 0.0f));
+		entities.emplace_back(spawn(1.0e9f, -1.0e9f));
+
+		/* only occupied cells are visited, however far the range reaches */
+		std::vector<ncs::Entity> found;
+		grid.radius(0.0f, 0.0f, 1.0e30f, found);
+		EXPECT_EQ(found.size(), 2);
+
+		found.clear();
+		grid.aabb(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+		          std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), found);
+		EXPECT_EQ(found.size(), 2);
+
+		found.clear();
+		grid.aabb(5.0f, 5.0f, 1.0e6f, 1.0e6f, found);
+		EXPECT_TRUE(found.empty());
+	}
+
+	/* the destroyed grid's observers are gone; a new grid starts from the current state */
+	world.set<Position>(entities[0], Position { 3.0f, 3.0f, 0.0f });
+	world.despawn(entities[1]);
+	ncs::SpatialGrid<Position> grid(world, 1.0f);
+	EXPECT_EQ(grid.size(), 1);
+}
+
+TEST_F(SpatialTest, IncludesColdEntities)
+{
+	const auto e = spawn(1.0f, 1.0f);
+	world.make_cold<Position>(std::filesystem::temp_directory_path().string());
+
+	ncs::SpatialGrid<Position> grid(world, 4.0f);
+	EXPECT_EQ(grid.size(), 1);
+
+	std::vector<ncs::Entity> found;
+	grid.radius(1.0f, 1.0f, 0.5f, found);
+	ASSERT_EQ(found.size(), 1);
+	EXPECT_EQ(found[0], e);
+}